@@ -0,0 +1,123 @@
+#include "bohr_diagram.h"
+#include "electron_config.h"
+#include <cmath>
+#include <cstdlib>
+
+// Sine and cosine of ANGLE_STEPS angles around the circle, scaled to
+// integer fixed point so an electron position is two multiplies and a shift
+const int ANGLE_STEPS = 1024;
+const int TRIG_SHIFT = 14;
+
+struct TrigTable {
+    int sine[ANGLE_STEPS];
+    int cosine[ANGLE_STEPS];
+};
+
+static const TrigTable* buildTrigTable() {
+    TrigTable* table = new TrigTable;
+    for(int i = 0; i < ANGLE_STEPS; i++) {
+        double angle = 2 * M_PI * i / ANGLE_STEPS;
+        table->sine[i] = (int)lround(sin(angle) * (1 << TRIG_SHIFT));
+        table->cosine[i] = (int)lround(cos(angle) * (1 << TRIG_SHIFT));
+    }
+    return table;
+}
+
+static const TrigTable& trigTable() {
+    static const TrigTable* table = buildTrigTable();
+    return *table;
+}
+
+void* diagramCache[ELEMENT_COUNT] = {};
+void* ringCache[ELEMENT_COUNT] = {};  // rings and nucleus only, for animation
+
+Rect bohrDiagramRect(int centerX, int centerY) {
+    Rect r = { centerX - BOHR_RADIUS, centerY - BOHR_RADIUS, centerX + BOHR_RADIUS, centerY + BOHR_RADIUS };
+    return r;
+}
+
+double bohrShellSpeed(int shell) {
+    return 0.6 / (shell + 1);
+}
+
+static int shellRadius(int shell) {
+    return BOHR_NUCLEUS_RADIUS + (shell + 1) * BOHR_SHELL_SPACING;
+}
+
+static void drawRings(RenderBackend* gfx, const Element& elem, int centerX, int centerY) {
+    gfx->setLineWidth(LINE_NORMAL);
+    gfx->setColor(COLOR_DARKGRAY);
+    for(int s = 0; s < shellCount(elem.atomicNumber); s++) {
+        gfx->circle(centerX, centerY, shellRadius(s));
+    }
+    
+    gfx->setColor(COLOR_BLACK);
+    gfx->setFillColor(elem.color);
+    gfx->fillCircle(centerX, centerY, BOHR_NUCLEUS_RADIUS);
+}
+
+// Function to place each shell's electrons evenly around its ring, the
+// shell turned by shellTurns[s] revolutions (NULL for the resting pose)
+static void drawElectrons(RenderBackend* gfx, const Element& elem, int centerX, int centerY,
+                          const double* shellTurns) {
+    const TrigTable& trig = trigTable();
+    const unsigned char* shells = shellOccupancy(elem.atomicNumber);
+    
+    gfx->setColor(COLOR_BLUE);
+    gfx->setFillColor(COLOR_BLUE);
+    for(int s = 0; s < shellCount(elem.atomicNumber); s++) {
+        int radius = shellRadius(s);
+        int electrons = shells[s];
+        
+        // Stagger each shell's first electron so the rings don't line up
+        int offset = s * ANGLE_STEPS / 16;
+        if(shellTurns != NULL) {
+            double turns = shellTurns[s] - floor(shellTurns[s]);
+            offset += (int)(turns * ANGLE_STEPS);
+        }
+        
+        for(int e = 0; e < electrons; e++) {
+            int step = (offset + (e * ANGLE_STEPS + electrons / 2) / electrons) % ANGLE_STEPS;
+            int x = centerX + ((radius * trig.cosine[step]) >> TRIG_SHIFT);
+            int y = centerY - ((radius * trig.sine[step]) >> TRIG_SHIFT);
+            gfx->fillCircle(x, y, BOHR_ELECTRON_RADIUS);
+        }
+    }
+}
+
+// Function to blit a cached image; returns false if nothing is cached yet
+static bool blitCached(RenderBackend* gfx, void*& cache, const Rect& r) {
+    if(cache == NULL) return false;
+    gfx->putImage(r.left, r.top, cache, IMAGE_COPY);
+    return true;
+}
+
+static void capture(RenderBackend* gfx, void*& cache, const Rect& r) {
+    cache = malloc(gfx->imageSize(r));
+    if(cache != NULL) gfx->getImage(r, cache);
+}
+
+void drawBohrDiagram(RenderBackend* gfx, const Element& elem, int centerX, int centerY) {
+    int index = elem.atomicNumber - 1;
+    Rect r = bohrDiagramRect(centerX, centerY);
+    if(blitCached(gfx, diagramCache[index], r)) return;
+    
+    gfx->setFillColor(COLOR_WHITE);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    drawRings(gfx, elem, centerX, centerY);
+    drawElectrons(gfx, elem, centerX, centerY, NULL);
+    capture(gfx, diagramCache[index], r);
+}
+
+void drawBohrDiagramAnimated(RenderBackend* gfx, const Element& elem, int centerX, int centerY,
+                             const double shellTurns[MAX_SHELLS]) {
+    int index = elem.atomicNumber - 1;
+    Rect r = bohrDiagramRect(centerX, centerY);
+    if(!blitCached(gfx, ringCache[index], r)) {
+        gfx->setFillColor(COLOR_WHITE);
+        gfx->bar(r.left, r.top, r.right, r.bottom);
+        drawRings(gfx, elem, centerX, centerY);
+        capture(gfx, ringCache[index], r);
+    }
+    drawElectrons(gfx, elem, centerX, centerY, shellTurns);
+}
@@ -0,0 +1,36 @@
+#ifndef BOHR_DIAGRAM_H
+#define BOHR_DIAGRAM_H
+
+#include "elements.h"
+#include "render_backend.h"
+#include "electron_config.h"
+
+// Bohr-model diagram for the detail popup: the nucleus and one ring per
+// occupied shell, with that shell's electrons spaced evenly around it.
+// Shell counts come from the precomputed occupancy table and electron
+// positions from a sine/cosine lookup table, so drawing needs no per-open
+// computation; the finished diagram is also cached per element, so every
+// opening after the first is one blit. The animated variant blits cached
+// rings and nucleus and draws only the electrons on top.
+
+const int BOHR_SHELL_SPACING = 16;
+const int BOHR_NUCLEUS_RADIUS = 10;
+const int BOHR_ELECTRON_RADIUS = 3;
+const int BOHR_RADIUS = BOHR_NUCLEUS_RADIUS + 7 * BOHR_SHELL_SPACING + BOHR_ELECTRON_RADIUS;
+
+// Area the diagram centred at (centerX, centerY) draws into
+Rect bohrDiagramRect(int centerX, int centerY);
+
+// Function to draw the diagram on a white background, from the cache if it
+// has been drawn before
+void drawBohrDiagram(RenderBackend* gfx, const Element& elem, int centerX, int centerY);
+
+// Function to draw the diagram with shell s turned shellTurns[s] revolutions
+// from its resting pose
+void drawBohrDiagramAnimated(RenderBackend* gfx, const Element& elem, int centerX, int centerY,
+                             const double shellTurns[MAX_SHELLS]);
+
+// Orbit speed of a shell (0 = innermost) in revolutions per second
+double bohrShellSpeed(int shell);
+
+#endif
@@ -0,0 +1,428 @@
+#include "chemical_formula.h"
+#include "mapped_file.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <thread>
+
+const long long MAX_COUNT = 999999999;        // largest count or coefficient written
+const long long MAX_ATOMS = 1000000000000LL;  // of one element, once groups are multiplied out
+const double MAX_MOLAR_MASS = 1e14;           // g/mol; keeps formatDecimal's scaled value in 64 bits
+const int MAX_CHARGE = 99;
+
+// One element symbol as written, with its count multiplied by every group
+// and coefficient around it so far
+struct FormulaTerm {
+    int element;
+    long long count;
+};
+
+struct FormulaParser {
+    const char* text;
+    const char* p;
+    const char* end;
+    FormulaTerm terms[MAX_FORMULA_TERMS];
+    int termCount;
+    FormulaResult* result;
+};
+
+static bool fail(FormulaParser& parser, const char* at, const char* message) {
+    parser.result->errorPosition = (int)(at - parser.text);
+    snprintf(parser.result->error, sizeof(parser.result->error), "%s", message);
+    return false;
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static void skipBlanks(FormulaParser& parser) {
+    while(parser.p < parser.end && (*parser.p == ' ' || *parser.p == '\t' || *parser.p == '\r')) parser.p++;
+}
+
+// Function to read the count after a symbol or group; 1 if none is written
+static bool readCount(FormulaParser& parser, long long& count) {
+    const char* at = parser.p;
+    count = 1;
+    if(parser.p == parser.end || !isDigit(*parser.p)) return true;
+    
+    count = 0;
+    while(parser.p < parser.end && isDigit(*parser.p)) {
+        count = count * 10 + (*parser.p++ - '0');
+        if(count > MAX_COUNT) return fail(parser, at, "count too large");
+    }
+    if(count == 0) return fail(parser, at, "count of zero");
+    return true;
+}
+
+// Function to multiply the terms written since from by a group's count
+static bool multiplyTerms(FormulaParser& parser, int from, long long factor, const char* at) {
+    if(factor == 1) return true;
+    for(int i = from; i < parser.termCount; i++) {
+        // Checked before multiplying, which could otherwise overflow
+        if(parser.terms[i].count > MAX_ATOMS / factor) return fail(parser, at, "too many atoms");
+        parser.terms[i].count *= factor;
+    }
+    return true;
+}
+
+// Function to measure the hydrate separator at p: '.', '*', or a middle
+// dot, bullet or dot operator in UTF-8 (or Latin-1 for the middle dot).
+// Returns 0 if there is none.
+static int separatorLength(const char* p, const char* end) {
+    const unsigned char* u = (const unsigned char*)p;
+    size_t left = (size_t)(end - p);
+    if(left == 0) return 0;
+    if(u[0] == '.' || u[0] == '*' || u[0] == 0xB7) return 1;
+    if(left >= 2 && u[0] == 0xC2 && u[1] == 0xB7) return 2;
+    if(left >= 3 && u[0] == 0xE2 && ((u[1] == 0x80 && u[2] == 0xA2) || (u[1] == 0x8B && u[2] == 0x85))) return 3;
+    return 0;
+}
+
+// Function to read the charge at the end: ^2-, 3-, +, ++, -2
+static bool parseCharge(FormulaParser& parser) {
+    skipBlanks(parser);
+    if(parser.p == parser.end) return true;
+    
+    const char* at = parser.p;
+    bool caret = *parser.p == '^';
+    if(caret) parser.p++;
+    
+    long long magnitude = 0;
+    char sign;
+    if(parser.p < parser.end && isDigit(*parser.p)) {
+        if(!readCount(parser, magnitude)) return false;
+        if(parser.p == parser.end || (*parser.p != '+' && *parser.p != '-')) {
+            return fail(parser, parser.p, "expected + or - after the charge");
+        }
+        sign = *parser.p++;
+    } else if(parser.p < parser.end && (*parser.p == '+' || *parser.p == '-')) {
+        sign = *parser.p;
+        while(parser.p < parser.end && *parser.p == sign) {
+            magnitude++;
+            parser.p++;
+        }
+        if(magnitude == 1 && !readCount(parser, magnitude)) return false;
+    } else {
+        return fail(parser, parser.p, caret ? "expected a charge after ^" : "unexpected character");
+    }
+    
+    skipBlanks(parser);
+    if(parser.p != parser.end) return fail(parser, parser.p, "unexpected character after the charge");
+    if(magnitude > MAX_CHARGE) return fail(parser, at, "charge too large");
+    parser.result->charge = (int)(sign == '+' ? magnitude : -magnitude);
+    return true;
+}
+
+// Function to merge the terms per element and weigh them
+static bool sumTerms(FormulaParser& parser, const ElementColumns& columns) {
+    FormulaResult& result = *parser.result;
+    for(int t = 0; t < parser.termCount; t++) {
+        const FormulaTerm& term = parser.terms[t];
+        int i = 0;
+        while(i < result.elementCount && result.element[i] != term.element) i++;
+        if(i == result.elementCount) {
+            if(i == MAX_FORMULA_ELEMENTS) return fail(parser, parser.text, "too many different elements");
+            result.element[i] = (short)term.element;
+            result.atoms[i] = 0;
+            result.elementCount++;
+        }
+        if(result.atoms[i] > MAX_ATOMS - term.count) return fail(parser, parser.text, "too many atoms");
+        result.atoms[i] += term.count;
+    }
+    
+    // massPercent holds each element's mass until the total is known
+    double total = 0;
+    for(int i = 0; i < result.elementCount; i++) {
+        double weight = columns.atomicWeight[result.element[i]];
+        if(std::isnan(weight)) {
+            char message[48];
+            snprintf(message, sizeof(message), "no atomic weight for %s", ELEMENTS[result.element[i]].symbol);
+            return fail(parser, parser.text, message);
+        }
+        result.massPercent[i] = (double)result.atoms[i] * weight;
+        total += result.massPercent[i];
+    }
+    if(total > MAX_MOLAR_MASS) return fail(parser, parser.text, "molar mass too large");
+    for(int i = 0; i < result.elementCount; i++) result.massPercent[i] = result.massPercent[i] / total * 100.0;
+    result.molarMass = total;
+    return true;
+}
+
+bool parseFormula(const char* text, size_t length, const ElementColumns& columns, FormulaResult& result) {
+    FormulaParser parser;
+    parser.text = text;
+    parser.p = text;
+    parser.end = text + length;
+    parser.termCount = 0;
+    parser.result = &result;
+    result.molarMass = 0;
+    result.charge = 0;
+    result.elementCount = 0;
+    result.errorPosition = -1;
+    result.error[0] = '\0';
+    
+    int groupStart[MAX_FORMULA_DEPTH];
+    char groupClose[MAX_FORMULA_DEPTH];
+    int depth = 0;
+    
+    skipBlanks(parser);
+    if(parser.p == parser.end) return fail(parser, parser.p, "empty formula");
+    
+    // One part per pass: an optional coefficient, then symbols and groups.
+    // Parts after the first are hydrate parts after a separator.
+    for(;;) {
+        skipBlanks(parser);
+        const char* partAt = parser.p;
+        long long coefficient;
+        if(!readCount(parser, coefficient)) return false;
+        int partStart = parser.termCount;
+        
+        while(parser.p < parser.end) {
+            char c = *parser.p;
+            if(c >= 'A' && c <= 'Z') {
+                const char* at = parser.p;
+                char lower = parser.p + 1 < parser.end && parser.p[1] >= 'a' && parser.p[1] <= 'z' ? parser.p[1] : '\0';
+                parser.p += lower == '\0' ? 1 : 2;
+                int element = SYMBOL_INDEX.slot[symbolSlot(c, lower)];
+                if(element < 0) {
+                    char message[48];
+                    snprintf(message, sizeof(message), "unknown element %.*s", (int)(parser.p - at), at);
+                    return fail(parser, at, message);
+                }
+                if(parser.termCount == MAX_FORMULA_TERMS) return fail(parser, at, "formula too long");
+                
+                FormulaTerm& term = parser.terms[parser.termCount++];
+                term.element = element;
+                if(!readCount(parser, term.count)) return false;
+            } else if(c == '(' || c == '[') {
+                if(depth == MAX_FORMULA_DEPTH) return fail(parser, parser.p, "groups nested too deep");
+                groupStart[depth] = parser.termCount;
+                groupClose[depth] = c == '(' ? ')' : ']';
+                depth++;
+                parser.p++;
+            } else if(c == ')' || c == ']') {
+                const char* at = parser.p;
+                if(depth == 0 || groupClose[depth - 1] != c) return fail(parser, at, "unmatched bracket");
+                depth--;
+                parser.p++;
+                if(groupStart[depth] == parser.termCount) return fail(parser, at, "empty group");
+                long long count;
+                if(!readCount(parser, count) || !multiplyTerms(parser, groupStart[depth], count, at)) return false;
+            } else {
+                break;
+            }
+        }
+        
+        if(depth > 0) return fail(parser, parser.p, "missing closing bracket");
+        if(parser.termCount == partStart) return fail(parser, parser.p, "expected an element");
+        if(!multiplyTerms(parser, partStart, coefficient, partAt)) return false;
+        
+        skipBlanks(parser);
+        int separator = separatorLength(parser.p, parser.end);
+        if(separator == 0) break;
+        parser.p += separator;
+    }
+    
+    if(!parseCharge(parser)) return false;
+    return sumTerms(parser, columns);
+}
+
+bool parseFormula(const char* text, const ElementColumns& columns, FormulaResult& result) {
+    return parseFormula(text, strlen(text), columns, result);
+}
+
+// Formulas with the result each must give: a molar mass, or the error
+struct FormulaCheck {
+    const char* formula;
+    double molarMass;  // 0 if it must be rejected
+    const char* error;
+};
+
+static const FormulaCheck FORMULA_CHECKS[] = {
+    { "H2O", 18.015, NULL },
+    { "K4[Fe(CN)6]", 368.35, NULL },
+    { "CuSO4\xC2\xB7" "5H2O", 249.68, NULL },
+    { "H999999999", 1007999998.992, NULL },
+    { "(H999999999)1000", 1007999998992.0, NULL },
+    { "((H999999999)1000)2", 0, "too many atoms" },
+    { "((H999999999)1000)9300000", 0, "too many atoms" },
+    { "999999999(H999999999)", 0, "too many atoms" },
+    { "(H1000000)1000000H", 0, "too many atoms" },
+    { "(U999999999)1000", 0, "molar mass too large" },
+    { "H0", 0, "count of zero" },
+    { "H1000000000", 0, "count too large" },
+};
+
+int validateFormulaParser(const ElementColumns& columns) {
+    int problems = 0;
+    int count = (int)(sizeof(FORMULA_CHECKS) / sizeof(FORMULA_CHECKS[0]));
+    for(int c = 0; c < count; c++) {
+        const FormulaCheck& check = FORMULA_CHECKS[c];
+        FormulaResult result;
+        bool parsed = parseFormula(check.formula, columns, result);
+        if(check.error != NULL && (parsed || strcmp(result.error, check.error) != 0)) {
+            printf("formula %s: expected \"%s\", got %s\n", check.formula, check.error, parsed ? "a result" : result.error);
+            problems++;
+        } else if(check.error == NULL && (!parsed || fabs(result.molarMass - check.molarMass) > check.molarMass * 1e-4)) {
+            printf("formula %s: expected %.4f g/mol, got %s\n", check.formula, check.molarMass, parsed ? "another mass" : result.error);
+            problems++;
+        }
+    }
+    printf("checked %d formulas: %d problem(s)\n", count, problems);
+    return problems;
+}
+
+// ---------------------------------------------------------------------------
+// Batch mode
+// ---------------------------------------------------------------------------
+
+const size_t MIN_CHUNK_BYTES = 64 * 1024;  // smaller inputs use fewer threads
+const int MAX_RESULT_CHARS = 96;           // output per line beyond the formula itself
+
+struct BatchChunk {
+    const char* begin;
+    const char* end;
+    const ElementColumns* columns;
+    char* output;
+    size_t outputSize;
+    long long lines;           // every line, for numbering errors
+    long long formulas;
+    long long errors;
+    long long firstErrorLine;  // within the chunk, 0 if none
+    char firstError[48];
+};
+
+int formatDecimal(char* out, double value, int decimals) {
+    static const double SCALE[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    int length = 0;
+    if(value < 0) {
+        out[length++] = '-';
+        value = -value;
+    }
+    unsigned long long scaled = (unsigned long long)llround(value * SCALE[decimals]);
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + scaled % 10);
+        scaled /= 10;
+    } while(scaled > 0 || n < decimals + 1);
+    
+    while(n > decimals) out[length++] = digits[--n];
+    if(decimals > 0) out[length++] = '.';
+    while(n > 0) out[length++] = digits[--n];
+    return length;
+}
+
+// Function to parse one chunk of lines into its output buffer
+static void processChunk(BatchChunk* chunk) {
+    long long newlines = 0;
+    for(const char* p = chunk->begin; p < chunk->end; p++) {
+        p = (const char*)memchr(p, '\n', (size_t)(chunk->end - p));
+        if(p == NULL) break;
+        newlines++;
+    }
+    size_t capacity = (size_t)(chunk->end - chunk->begin) + (size_t)(newlines + 1) * MAX_RESULT_CHARS;
+    chunk->output = (char*)malloc(capacity);
+    if(chunk->output == NULL) return;
+    
+    FormulaResult result;
+    char* out = chunk->output;
+    const char* line = chunk->begin;
+    while(line < chunk->end) {
+        const char* lineEnd = (const char*)memchr(line, '\n', (size_t)(chunk->end - line));
+        if(lineEnd == NULL) lineEnd = chunk->end;
+        chunk->lines++;
+        
+        const char* first = line;
+        const char* last = lineEnd;
+        while(first < last && (*first == ' ' || *first == '\t')) first++;
+        while(last > first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+        
+        if(first < last && *first != '#') {
+            chunk->formulas++;
+            size_t length = (size_t)(last - first);
+            memcpy(out, first, length);
+            out += length;
+            *out++ = ',';
+            if(parseFormula(first, length, *chunk->columns, result)) {
+                out += formatDecimal(out, result.molarMass, 4);
+            } else {
+                if(chunk->errors++ == 0) {
+                    chunk->firstErrorLine = chunk->lines;
+                    memcpy(chunk->firstError, result.error, sizeof(chunk->firstError));
+                }
+                out += sprintf(out, ",%s at column %d", result.error, result.errorPosition + 1);
+            }
+            *out++ = '\n';
+        }
+        line = lineEnd + 1;
+    }
+    chunk->outputSize = (size_t)(out - chunk->output);
+}
+
+void runFormulaBatch(const char* data, size_t size, const ElementColumns& columns, int threads, FILE* out,
+                     FormulaBatchReport& report) {
+    memset(&report, 0, sizeof(report));
+    if(threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if(threads <= 0) threads = 1;
+    if(threads > MAX_BATCH_THREADS) threads = MAX_BATCH_THREADS;
+    if((size_t)threads > size / MIN_CHUNK_BYTES + 1) threads = (int)(size / MIN_CHUNK_BYTES + 1);
+    
+    // Cut at line boundaries, roughly equal in size
+    BatchChunk chunks[MAX_BATCH_THREADS];
+    memset(chunks, 0, sizeof(chunks));
+    const char* end = data + size;
+    const char* begin = data;
+    for(int t = 0; t < threads; t++) {
+        const char* cut = t == threads - 1 ? end : data + size / threads * (t + 1);
+        if(cut < begin) cut = begin;
+        const char* newline = cut < end ? (const char*)memchr(cut, '\n', (size_t)(end - cut)) : NULL;
+        if(t < threads - 1) cut = newline != NULL ? newline + 1 : end;
+        chunks[t].begin = begin;
+        chunks[t].end = cut;
+        chunks[t].columns = &columns;
+        begin = cut;
+    }
+    
+    long long start = timerNow();
+    std::thread workers[MAX_BATCH_THREADS];
+    for(int t = 1; t < threads; t++) workers[t] = std::thread(processChunk, &chunks[t]);
+    processChunk(&chunks[0]);
+    for(int t = 1; t < threads; t++) workers[t].join();
+    report.ms = timerMs(timerNow() - start);
+    report.threads = threads;
+    
+    long long linesBefore = 0;
+    for(int t = 0; t < threads; t++) {
+        BatchChunk& chunk = chunks[t];
+        if(chunk.output == NULL && chunk.begin < chunk.end) {
+            report.errors++;
+            if(report.firstErrorLine == 0) snprintf(report.firstError, sizeof(report.firstError), "out of memory");
+        }
+        if(chunk.errors > 0 && report.firstErrorLine == 0) {
+            report.firstErrorLine = linesBefore + chunk.firstErrorLine;
+            memcpy(report.firstError, chunk.firstError, sizeof(report.firstError));
+        }
+        report.formulas += chunk.formulas;
+        report.errors += chunk.errors;
+        linesBefore += chunk.lines;
+        
+        if(out != NULL && chunk.outputSize > 0) fwrite(chunk.output, 1, chunk.outputSize, out);
+        free(chunk.output);
+    }
+}
+
+bool runFormulaBatchFile(const char* path, const ElementColumns& columns, int threads, FILE* out,
+                         FormulaBatchReport& report) {
+    MappedFile file;
+    if(!mapFile(path, file)) {
+        memset(&report, 0, sizeof(report));
+        return false;
+    }
+    runFormulaBatch(file.data, file.size, columns, threads, out, report);
+    unmapFile(file);
+    return true;
+}
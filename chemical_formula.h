@@ -0,0 +1,79 @@
+#ifndef CHEMICAL_FORMULA_H
+#define CHEMICAL_FORMULA_H
+
+#include "element_columns.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// Molar mass and mass-percent composition from a chemical formula, with
+// atomic weights taken from the property columns. Accepted:
+//
+//   H2O  C6H12O6  Ca(OH)2  K4[Fe(CN)6]       groups in () or [], nested
+//   CuSO4·5H2O  Ca(OH)2.2H2O  Na2CO3*10H2O   hydrates (·, . or *), with a count
+//   NH4+  SO4^2-  Fe+3  PO4 3-  O--          a charge at the end
+//
+// Symbols are case-sensitive ("Co" is cobalt, "CO" carbon monoxide) and are
+// resolved through SYMBOL_INDEX, a direct-indexed table, so parsing does no
+// string comparisons. A charge written as digits then sign needs a ^ or a
+// space before it, since "SO42-" would read as SO42 with charge 1-. The
+// electron mass is not taken off for ions (under 0.001 g/mol per charge).
+
+const int MAX_FORMULA_ELEMENTS = 24;  // distinct elements in one formula
+const int MAX_FORMULA_TERMS = 96;     // element symbols written out
+const int MAX_FORMULA_DEPTH = 8;      // nested groups
+
+struct FormulaResult {
+    double molarMass;                             // g/mol
+    int charge;
+    int elementCount;
+    short element[MAX_FORMULA_ELEMENTS];          // indexes into ELEMENTS, in order of appearance
+    long long atoms[MAX_FORMULA_ELEMENTS];
+    double massPercent[MAX_FORMULA_ELEMENTS];
+    int errorPosition;                            // byte offset into the text
+    char error[48];
+};
+
+// Function to parse length bytes of text. Returns false and fills
+// result.error if the formula is malformed or names an element without a
+// weight.
+bool parseFormula(const char* text, size_t length, const ElementColumns& columns, FormulaResult& result);
+bool parseFormula(const char* text, const ElementColumns& columns, FormulaResult& result);
+
+// Function to parse a fixed list of formulas, limits included, and check
+// each result. Prints each problem and returns the count.
+int validateFormulaParser(const ElementColumns& columns);
+
+// Function to write value with a fixed number of decimals (0 to 6) and no
+// terminator; returns the length. Several times quicker than printf, which
+// would otherwise be most of the cost of formatting results. value scaled
+// by 10^decimals must fit in 64 bits.
+int formatDecimal(char* out, double value, int decimals);
+
+// Batch mode: one formula per line; blank lines and # comments are skipped.
+// The input is split at line boundaries into one chunk per thread, each
+// thread parses and formats its chunk into its own buffer, and the buffers
+// are written out in input order. Output lines are "formula,mass" or
+// "formula,,error at column N".
+
+const int MAX_BATCH_THREADS = 64;
+
+struct FormulaBatchReport {
+    long long formulas;      // lines parsed
+    long long errors;
+    int threads;
+    double ms;               // parse + format, not the final write
+    long long firstErrorLine;
+    char firstError[48];
+};
+
+// Function to process a batch held in memory. threads 0 means one per
+// core; out may be NULL to only parse and format.
+void runFormulaBatch(const char* data, size_t size, const ElementColumns& columns, int threads, FILE* out,
+                     FormulaBatchReport& report);
+
+// Function to map a file and process it as a batch. Returns false if the
+// file could not be opened.
+bool runFormulaBatchFile(const char* path, const ElementColumns& columns, int threads, FILE* out,
+                         FormulaBatchReport& report);
+
+#endif
@@ -0,0 +1,224 @@
+#include "electron_config.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+constexpr Subshell SUBSHELLS[SUBSHELL_COUNT] = {
+    {1, 0, 2},
+    {2, 0, 2}, {2, 1, 6},
+    {3, 0, 2}, {3, 1, 6}, {3, 2, 10},
+    {4, 0, 2}, {4, 1, 6}, {4, 2, 10}, {4, 3, 14},
+    {5, 0, 2}, {5, 1, 6}, {5, 2, 10}, {5, 3, 14},
+    {6, 0, 2}, {6, 1, 6}, {6, 2, 10},
+    {7, 0, 2}, {7, 1, 6}
+};
+
+const char SUBSHELL_LETTERS[] = "spdf";
+
+constexpr int subshellAt(int n, int l) {
+    for(int i = 0; i < SUBSHELL_COUNT; i++) {
+        if(SUBSHELLS[i].n == n && SUBSHELLS[i].l == l) return i;
+    }
+    return -1;
+}
+
+// Ground states that break the Madelung order, as electrons moved from one
+// subshell to another after the normal filling
+struct AufbauException {
+    int atomicNumber;
+    int fromN, fromL;
+    int toN, toL;
+    int count;
+};
+
+constexpr AufbauException AUFBAU_EXCEPTIONS[] = {
+    { 24, 4, 0, 3, 2, 1 },   // Cr  3d5 4s1
+    { 29, 4, 0, 3, 2, 1 },   // Cu  3d10 4s1
+    { 41, 5, 0, 4, 2, 1 },   // Nb  4d4 5s1
+    { 42, 5, 0, 4, 2, 1 },   // Mo  4d5 5s1
+    { 44, 5, 0, 4, 2, 1 },   // Ru  4d7 5s1
+    { 45, 5, 0, 4, 2, 1 },   // Rh  4d8 5s1
+    { 46, 5, 0, 4, 2, 2 },   // Pd  4d10
+    { 47, 5, 0, 4, 2, 1 },   // Ag  4d10 5s1
+    { 57, 4, 3, 5, 2, 1 },   // La  5d1 6s2
+    { 58, 4, 3, 5, 2, 1 },   // Ce  4f1 5d1 6s2
+    { 64, 4, 3, 5, 2, 1 },   // Gd  4f7 5d1 6s2
+    { 78, 6, 0, 5, 2, 1 },   // Pt  5d9 6s1
+    { 79, 6, 0, 5, 2, 1 },   // Au  5d10 6s1
+    { 89, 5, 3, 6, 2, 1 },   // Ac  6d1 7s2
+    { 90, 5, 3, 6, 2, 2 },   // Th  6d2 7s2
+    { 91, 5, 3, 6, 2, 1 },   // Pa  5f2 6d1 7s2
+    { 92, 5, 3, 6, 2, 1 },   // U   5f3 6d1 7s2
+    { 93, 5, 3, 6, 2, 1 },   // Np  5f4 6d1 7s2
+    { 96, 5, 3, 6, 2, 1 },   // Cm  5f7 6d1 7s2
+    { 103, 6, 2, 7, 1, 1 }   // Lr  5f14 7s2 7p1
+};
+
+const int AUFBAU_EXCEPTION_COUNT = sizeof(AUFBAU_EXCEPTIONS) / sizeof(AUFBAU_EXCEPTIONS[0]);
+
+struct OccupancyTable {
+    ElectronConfig config[ELEMENT_COUNT + 1];              // by atomic number
+    unsigned char shells[ELEMENT_COUNT + 1][MAX_SHELLS];
+    unsigned char shellCount[ELEMENT_COUNT + 1];
+};
+
+// Function to fill electrons into subshells in Madelung order
+constexpr ElectronConfig madelungConfig(int atomicNumber) {
+    ElectronConfig config = {};
+    int left = atomicNumber;
+    for(int sum = 1; left > 0 && sum <= 8; sum++) {
+        // Within one n + l, lower n fills first, i.e. higher l
+        for(int l = sum - 1; l >= 0 && left > 0; l--) {
+            int index = subshellAt(sum - l, l);
+            if(index < 0) continue;
+            int take = left < SUBSHELLS[index].capacity ? left : SUBSHELLS[index].capacity;
+            config.electrons[index] = (unsigned char)take;
+            left -= take;
+        }
+    }
+    return config;
+}
+
+constexpr OccupancyTable buildOccupancyTable() {
+    OccupancyTable table = {};
+    for(int z = 1; z <= ELEMENT_COUNT; z++) {
+        ElectronConfig config = madelungConfig(z);
+        for(int e = 0; e < AUFBAU_EXCEPTION_COUNT; e++) {
+            const AufbauException& ex = AUFBAU_EXCEPTIONS[e];
+            if(ex.atomicNumber != z) continue;
+            config.electrons[subshellAt(ex.fromN, ex.fromL)] -= ex.count;
+            config.electrons[subshellAt(ex.toN, ex.toL)] += ex.count;
+        }
+        table.config[z] = config;
+        
+        for(int i = 0; i < SUBSHELL_COUNT; i++) {
+            int shell = SUBSHELLS[i].n - 1;
+            table.shells[z][shell] += config.electrons[i];
+            if(config.electrons[i] > 0 && shell + 1 > table.shellCount[z]) {
+                table.shellCount[z] = (unsigned char)(shell + 1);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr OccupancyTable OCCUPANCY = buildOccupancyTable();
+
+constexpr bool occupancyConsistent() {
+    for(int z = 1; z <= ELEMENT_COUNT; z++) {
+        int total = 0;
+        for(int i = 0; i < SUBSHELL_COUNT; i++) {
+            if(OCCUPANCY.config[z].electrons[i] > SUBSHELLS[i].capacity) return false;
+            total += OCCUPANCY.config[z].electrons[i];
+        }
+        if(total != z) return false;
+    }
+    return true;
+}
+
+static_assert(occupancyConsistent(), "a generated configuration overfills a subshell or loses electrons");
+
+int subshellIndex(int n, int l) {
+    return subshellAt(n, l);
+}
+
+const ElectronConfig& groundStateConfig(int atomicNumber) {
+    return OCCUPANCY.config[atomicNumber];
+}
+
+const unsigned char* shellOccupancy(int atomicNumber) {
+    return OCCUPANCY.shells[atomicNumber];
+}
+
+int shellCount(int atomicNumber) {
+    return OCCUPANCY.shellCount[atomicNumber];
+}
+
+int nobleCore(int atomicNumber) {
+    static const int nobleGases[] = { 86, 54, 36, 18, 10, 2 };
+    for(int i = 0; i < 6; i++) {
+        if(nobleGases[i] < atomicNumber) return nobleGases[i];
+    }
+    return 0;
+}
+
+int configElectrons(const ElectronConfig& config) {
+    int total = 0;
+    for(int i = 0; i < SUBSHELL_COUNT; i++) total += config.electrons[i];
+    return total;
+}
+
+// Function to find the table entry for a bracketed core symbol such as "Ar"
+static int coreAtomicNumber(const char* symbol, int length) {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        const Element& elem = ELEMENTS[i];
+        if(elem.color == NOBLE_GAS && (int)strlen(elem.symbol) == length &&
+           strncmp(elem.symbol, symbol, length) == 0) return elem.atomicNumber;
+    }
+    return 0;
+}
+
+bool parseElectronConfig(const char* text, ElectronConfig& config) {
+    memset(&config, 0, sizeof(config));
+    const char* at = text;
+    
+    while(*at) {
+        if(isspace((unsigned char)*at)) {
+            at++;
+            continue;
+        }
+        
+        if(*at == '[') {
+            const char* close = strchr(at, ']');
+            if(close == NULL) return false;
+            int core = coreAtomicNumber(at + 1, close - at - 1);
+            if(core == 0) return false;
+            const ElectronConfig& coreConfig = groundStateConfig(core);
+            for(int i = 0; i < SUBSHELL_COUNT; i++) config.electrons[i] += coreConfig.electrons[i];
+            at = close + 1;
+            continue;
+        }
+        
+        // n, subshell letter, electron count: "4f14"
+        if(!isdigit((unsigned char)at[0])) return false;
+        int n = at[0] - '0';
+        const char* letter = at[1] ? strchr(SUBSHELL_LETTERS, tolower((unsigned char)at[1])) : NULL;
+        if(letter == NULL) return false;
+        int l = letter - SUBSHELL_LETTERS;
+        at += 2;
+        
+        char* end;
+        long electrons = isdigit((unsigned char)*at) ? strtol(at, &end, 10) : 1;
+        if(isdigit((unsigned char)*at)) at = end;
+        
+        int index = subshellIndex(n, l);
+        if(index < 0) return false;
+        if(config.electrons[index] + electrons > SUBSHELLS[index].capacity) return false;
+        config.electrons[index] += (unsigned char)electrons;
+    }
+    return true;
+}
+
+void formatElectronConfig(const ElectronConfig& config, char* out, int size, bool useCore) {
+    int length = 0;
+    out[0] = '\0';
+    
+    // Leave out the core only if it is exactly a noble-gas configuration
+    const ElectronConfig* core = NULL;
+    int coreZ = useCore ? nobleCore(configElectrons(config)) : 0;
+    if(coreZ > 0) {
+        core = &groundStateConfig(coreZ);
+        for(int i = 0; i < SUBSHELL_COUNT; i++) {
+            if(core->electrons[i] > 0 && core->electrons[i] != config.electrons[i]) core = NULL;
+            if(core == NULL) break;
+        }
+        if(core != NULL) length += snprintf(out + length, size - length, "[%s]", ELEMENTS[coreZ - 1].symbol);
+    }
+    
+    for(int i = 0; i < SUBSHELL_COUNT && length < size; i++) {
+        if(config.electrons[i] == 0 || (core != NULL && core->electrons[i] > 0)) continue;
+        length += snprintf(out + length, size - length, "%s%d%c%d", length > 0 ? " " : "",
+                           SUBSHELLS[i].n, SUBSHELL_LETTERS[SUBSHELLS[i].l], config.electrons[i]);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ELECTRON_CONFIG_H
+#define ELECTRON_CONFIG_H
+
+#include "elements.h"
+
+// Electron configurations as subshell occupancy counts.
+//
+// Ground-state configurations for all 118 elements are generated at compile
+// time by filling subshells in Madelung (n + l, then n) order and applying
+// the known exceptions from a table. The results, and the per-shell totals
+// the Bohr diagram needs, are kept in one constant array, so reading them is
+// an index and never string work.
+
+const int SUBSHELL_COUNT = 19;  // 1s through 7p
+const int MAX_SHELLS = 7;
+
+struct Subshell {
+    unsigned char n;
+    unsigned char l;
+    unsigned char capacity;
+};
+
+// Every subshell occupied in a ground state, ordered by n then l
+extern const Subshell SUBSHELLS[SUBSHELL_COUNT];
+
+// Electrons in each subshell, indexed like SUBSHELLS
+struct ElectronConfig {
+    unsigned char electrons[SUBSHELL_COUNT];
+};
+
+// Function to find a subshell's index in SUBSHELLS; -1 if it is not there
+int subshellIndex(int n, int l);
+
+// Function to parse a configuration such as "[Ar] 3d10 4s2 4p1" or
+// "1s2 2s2 2p6". Returns false on malformed text or an overfilled subshell.
+bool parseElectronConfig(const char* text, ElectronConfig& config);
+
+// Function to count the electrons in a configuration
+int configElectrons(const ElectronConfig& config);
+
+// Function to write a configuration as text, optionally abbreviating the
+// noble-gas core ("[Kr] 4d10 5s1")
+void formatElectronConfig(const ElectronConfig& config, char* out, int size, bool useCore);
+
+// Precomputed ground state of an element (atomic number 1..ELEMENT_COUNT)
+const ElectronConfig& groundStateConfig(int atomicNumber);
+
+// Electrons in shells n = 1..MAX_SHELLS, and how many shells are occupied
+const unsigned char* shellOccupancy(int atomicNumber);
+int shellCount(int atomicNumber);
+
+// Atomic number of the noble gas whose configuration forms the core, 0 for
+// hydrogen and helium
+int nobleCore(int atomicNumber);
+
+#endif
@@ -0,0 +1,347 @@
+#include "element_columns.h"
+#include "element_data.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLUMNS_SSE2 1
+#endif
+
+static const double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+void buildElementColumns(ElementColumns& columns, const Element elements[], int count) {
+    memset(&columns, 0, sizeof(columns));
+    for(int i = 0; i < COLUMN_CAPACITY; i++) {
+        columns.atomicWeight[i] = MISSING;
+        columns.atomicRadius[i] = MISSING;
+        columns.electronegativity[i] = MISSING;
+        columns.ionizationEnergy[i] = MISSING;
+        columns.density[i] = MISSING;
+        columns.meltingPoint[i] = MISSING;
+        columns.boilingPoint[i] = MISSING;
+    }
+    
+    for(int i = 0; i < count && i < COLUMN_CAPACITY; i++) {
+        const Element& elem = elements[i];
+        columns.atomicNumber[i] = elem.atomicNumber;
+        columns.period[i] = elem.period;
+        columns.group[i] = elem.group;
+        columns.color[i] = elem.color;
+        columns.block[i] = elem.block[0];
+        columns.atomicWeight[i] = elem.atomicWeight;
+    }
+    columns.count = count < COLUMN_CAPACITY ? count : COLUMN_CAPACITY;
+}
+
+static std::atomic<const ElementColumns*> currentColumns(NULL);
+static std::atomic<unsigned> columnsGeneration(1);
+
+const ElementColumns& elementColumns() {
+    const ElementColumns* columns = currentColumns.load(std::memory_order_acquire);
+    if(columns != NULL) return *columns;
+    
+    // First use: load once, unless a publish got in first
+    static const ElementColumns* initial = loadDefaultColumns();
+    const ElementColumns* expected = NULL;
+    currentColumns.compare_exchange_strong(expected, initial, std::memory_order_acq_rel);
+    return *currentColumns.load(std::memory_order_acquire);
+}
+
+const ElementColumns* publishElementColumns(const ElementColumns* columns) {
+    elementColumns();  // the initial load must not overwrite this later
+    const ElementColumns* previous = currentColumns.exchange(columns, std::memory_order_acq_rel);
+    columnsGeneration.fetch_add(1, std::memory_order_release);
+    return previous;
+}
+
+unsigned elementColumnsGeneration() {
+    return columnsGeneration.load(std::memory_order_acquire);
+}
+
+const double* propertyColumn(const ElementColumns& columns, int property) {
+    switch(property) {
+        case PROP_ATOMIC_RADIUS: return columns.atomicRadius;
+        case PROP_ELECTRONEGATIVITY: return columns.electronegativity;
+        case PROP_IONIZATION_ENERGY: return columns.ionizationEnergy;
+        case PROP_DENSITY: return columns.density;
+        case PROP_MELTING_POINT: return columns.meltingPoint;
+        case PROP_BOILING_POINT: return columns.boilingPoint;
+        default: return columns.atomicWeight;
+    }
+}
+
+double* propertyColumn(ElementColumns& columns, int property) {
+    return const_cast<double*>(propertyColumn((const ElementColumns&)columns, property));
+}
+
+const char* propertyName(int property) {
+    const char* names[] = {
+        "atomic weight", "atomic radius", "electronegativity", "ionization energy",
+        "density", "melting point", "boiling point"
+    };
+    return property >= 0 && property < PROP_COUNT ? names[property] : "";
+}
+
+const char* propertyUnit(int property) {
+    const char* units[] = { "u", "pm", "", "eV", "g/cm3", "K", "K" };
+    return property >= 0 && property < PROP_COUNT ? units[property] : "";
+}
+
+// ---------------------------------------------------------------------------
+// Masks
+// ---------------------------------------------------------------------------
+
+ElementMask emptyMask() {
+    ElementMask mask;
+    memset(&mask, 0, sizeof(mask));
+    return mask;
+}
+
+ElementMask fullMask(int count) {
+    ElementMask mask = emptyMask();
+    for(int i = 0; i < count; i++) maskSet(mask, i);
+    return mask;
+}
+
+bool maskTest(const ElementMask& mask, int index) {
+    return (mask.words[index >> 6] >> (index & 63)) & 1;
+}
+
+void maskSet(ElementMask& mask, int index) {
+    mask.words[index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+ElementMask maskAnd(const ElementMask& a, const ElementMask& b) {
+    ElementMask r;
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) r.words[w] = a.words[w] & b.words[w];
+    return r;
+}
+
+ElementMask maskOr(const ElementMask& a, const ElementMask& b) {
+    ElementMask r;
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) r.words[w] = a.words[w] | b.words[w];
+    return r;
+}
+
+ElementMask maskAndNot(const ElementMask& a, const ElementMask& b) {
+    ElementMask r;
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) r.words[w] = a.words[w] & ~b.words[w];
+    return r;
+}
+
+bool maskEqual(const ElementMask& a, const ElementMask& b) {
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) {
+        if(a.words[w] != b.words[w]) return false;
+    }
+    return true;
+}
+
+int maskCount(const ElementMask& mask) {
+    int count = 0;
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) {
+#if defined(__GNUC__)
+        count += __builtin_popcountll(mask.words[w]);
+#else
+        uint64_t bits = mask.words[w];
+        while(bits) {
+            bits &= bits - 1;
+            count++;
+        }
+#endif
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Filter kernels
+//
+// The SSE2 versions compare two doubles (or four ints) per instruction and
+// turn the comparison into mask bits with movemask. Comparisons against NaN
+// are always false, so padding and missing values never match.
+// ---------------------------------------------------------------------------
+
+enum CompareOp {
+    COMPARE_GREATER,
+    COMPARE_LESS,
+    COMPARE_RANGE
+};
+
+static ElementMask compareColumn(const double* column, int op, double a, double b) {
+    ElementMask mask = emptyMask();
+#ifdef COLUMNS_SSE2
+    __m128d va = _mm_set1_pd(a);
+    __m128d vb = _mm_set1_pd(b);
+    // Bits are gathered in a register one 64-element word at a time, with one
+    // loop per operator so the comparison is not re-chosen per vector
+    for(int w = 0; w < COLUMN_CAPACITY / 64; w++) {
+        const double* x = column + w * 64;
+        uint64_t bits = 0;
+        if(op == COMPARE_GREATER) {
+            for(int j = 0; j < 64; j += 2) {
+                bits |= (uint64_t)_mm_movemask_pd(_mm_cmpgt_pd(_mm_load_pd(x + j), va)) << j;
+            }
+        } else if(op == COMPARE_LESS) {
+            for(int j = 0; j < 64; j += 2) {
+                bits |= (uint64_t)_mm_movemask_pd(_mm_cmplt_pd(_mm_load_pd(x + j), va)) << j;
+            }
+        } else {
+            for(int j = 0; j < 64; j += 2) {
+                __m128d v = _mm_load_pd(x + j);
+                bits |= (uint64_t)_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(v, va), _mm_cmple_pd(v, vb))) << j;
+            }
+        }
+        mask.words[w] = bits;
+    }
+#else
+    for(int i = 0; i < COLUMN_CAPACITY; i++) {
+        double x = column[i];
+        bool hit = op == COMPARE_GREATER ? x > a : op == COMPARE_LESS ? x < a : (x >= a && x <= b);
+        if(hit) maskSet(mask, i);
+    }
+#endif
+    return mask;
+}
+
+ElementMask maskGreater(const double* column, double threshold) {
+    return compareColumn(column, COMPARE_GREATER, threshold, 0);
+}
+
+ElementMask maskLess(const double* column, double threshold) {
+    return compareColumn(column, COMPARE_LESS, threshold, 0);
+}
+
+ElementMask maskRange(const double* column, double low, double high) {
+    return compareColumn(column, COMPARE_RANGE, low, high);
+}
+
+ElementMask maskIntEquals(const int32_t* column, int value) {
+    ElementMask mask = emptyMask();
+#ifdef COLUMNS_SSE2
+    __m128i v = _mm_set1_epi32(value);
+    for(int i = 0; i < COLUMN_CAPACITY; i += 4) {
+        __m128i x = _mm_load_si128((const __m128i*)(column + i));
+        int bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, v)));
+        mask.words[i >> 6] |= (uint64_t)bits << (i & 63);
+    }
+#else
+    for(int i = 0; i < COLUMN_CAPACITY; i++) {
+        if(column[i] == value) maskSet(mask, i);
+    }
+#endif
+    return mask;
+}
+
+ElementMask maskIntRange(const int32_t* column, int low, int high) {
+    ElementMask mask = emptyMask();
+#ifdef COLUMNS_SSE2
+    // low <= x <= high  is  !(x < low) && !(x > high)
+    __m128i vlow = _mm_set1_epi32(low);
+    __m128i vhigh = _mm_set1_epi32(high);
+    for(int i = 0; i < COLUMN_CAPACITY; i += 4) {
+        __m128i x = _mm_load_si128((const __m128i*)(column + i));
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi32(x, vlow), _mm_cmpgt_epi32(x, vhigh));
+        int bits = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+        mask.words[i >> 6] |= (uint64_t)bits << (i & 63);
+    }
+#else
+    for(int i = 0; i < COLUMN_CAPACITY; i++) {
+        if(column[i] >= low && column[i] <= high) maskSet(mask, i);
+    }
+#endif
+    return mask;
+}
+
+ElementMask maskBlock(const ElementColumns& columns, char block) {
+    ElementMask mask = emptyMask();
+#ifdef COLUMNS_SSE2
+    __m128i v = _mm_set1_epi8(block);
+    for(int i = 0; i < COLUMN_CAPACITY; i += 16) {
+        __m128i x = _mm_load_si128((const __m128i*)(columns.block + i));
+        int bits = _mm_movemask_epi8(_mm_cmpeq_epi8(x, v));
+        mask.words[i >> 6] |= (uint64_t)(bits & 0xFFFF) << (i & 63);
+    }
+#else
+    for(int i = 0; i < COLUMN_CAPACITY; i++) {
+        if(columns.block[i] == block) maskSet(mask, i);
+    }
+#endif
+    if(block == '\0') mask = maskAnd(mask, fullMask(columns.count));  // padding is '\0'
+    return mask;
+}
+
+// ---------------------------------------------------------------------------
+// Reductions
+// ---------------------------------------------------------------------------
+
+ColumnStats columnStats(const double* column, int count, const ElementMask* filter) {
+    double inf = std::numeric_limits<double>::infinity();
+    double minValue = inf;
+    double maxValue = -inf;
+    double sum = 0;
+    int used = 0;
+    int i = 0;
+    
+#ifdef COLUMNS_SSE2
+    // Lane masks for each pair of filter bits
+    const __m128d laneMasks[4] = {
+        _mm_castsi128_pd(_mm_set_epi64x(0, 0)),
+        _mm_castsi128_pd(_mm_set_epi64x(0, -1)),
+        _mm_castsi128_pd(_mm_set_epi64x(-1, 0)),
+        _mm_castsi128_pd(_mm_set_epi64x(-1, -1))
+    };
+    const __m128d vinf = _mm_set1_pd(inf);
+    const __m128d vneginf = _mm_set1_pd(-inf);
+    const __m128d vone = _mm_set1_pd(1.0);
+    
+    // Two independent accumulator sets so consecutive vectors do not wait on
+    // each other's min/max/add latency
+    __m128d vmin[2] = { vinf, vinf };
+    __m128d vmax[2] = { vneginf, vneginf };
+    __m128d vsum[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    __m128d vused[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    for(; i + 4 <= count; i += 4) {
+        for(int k = 0; k < 2; k++) {
+            int at = i + 2 * k;
+            __m128d x = _mm_load_pd(column + at);
+            __m128d keep = _mm_cmpord_pd(x, x);  // drops NaN
+            if(filter != NULL) keep = _mm_and_pd(keep, laneMasks[(filter->words[at >> 6] >> (at & 63)) & 3]);
+            
+            // Lanes that are not kept become +inf / -inf / 0 so they cannot win
+            __m128d kept = _mm_and_pd(keep, x);
+            vmin[k] = _mm_min_pd(vmin[k], _mm_or_pd(kept, _mm_andnot_pd(keep, vinf)));
+            vmax[k] = _mm_max_pd(vmax[k], _mm_or_pd(kept, _mm_andnot_pd(keep, vneginf)));
+            vsum[k] = _mm_add_pd(vsum[k], kept);
+            vused[k] = _mm_add_pd(vused[k], _mm_and_pd(keep, vone));
+        }
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_min_pd(vmin[0], vmin[1]));
+    minValue = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes, _mm_max_pd(vmax[0], vmax[1]));
+    maxValue = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes, _mm_add_pd(vsum[0], vsum[1]));
+    sum = lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, _mm_add_pd(vused[0], vused[1]));
+    used = (int)(lanes[0] + lanes[1]);
+#endif
+    
+    for(; i < count; i++) {
+        double x = column[i];
+        if(std::isnan(x)) continue;
+        if(filter != NULL && !maskTest(*filter, i)) continue;
+        if(x < minValue) minValue = x;
+        if(x > maxValue) maxValue = x;
+        sum += x;
+        used++;
+    }
+    
+    ColumnStats stats;
+    stats.count = used;
+    stats.min = used > 0 ? minValue : MISSING;
+    stats.max = used > 0 ? maxValue : MISSING;
+    stats.mean = used > 0 ? sum / used : MISSING;
+    return stats;
+}
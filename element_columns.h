@@ -0,0 +1,101 @@
+#ifndef ELEMENT_COLUMNS_H
+#define ELEMENT_COLUMNS_H
+
+#include "elements.h"
+#include <stdint.h>
+
+// Struct-of-arrays copy of the element table for analytics. Each numeric
+// property is a contiguous, aligned column padded to COLUMN_CAPACITY entries
+// so the filter and reduce kernels can run whole SIMD vectors without a
+// bounds check. Missing values and padding are NaN, which every comparison
+// treats as "no match" and every reduction skips.
+
+const int COLUMN_CAPACITY = 128;
+
+// One bit per element: bit i set means ELEMENTS[i] matched
+struct ElementMask {
+    uint64_t words[COLUMN_CAPACITY / 64];
+};
+
+enum ElementProperty {
+    PROP_ATOMIC_WEIGHT,
+    PROP_ATOMIC_RADIUS,
+    PROP_ELECTRONEGATIVITY,
+    PROP_IONIZATION_ENERGY,
+    PROP_DENSITY,
+    PROP_MELTING_POINT,
+    PROP_BOILING_POINT,
+    PROP_COUNT
+};
+
+struct ElementColumns {
+    alignas(32) double atomicWeight[COLUMN_CAPACITY];
+    alignas(32) double atomicRadius[COLUMN_CAPACITY];
+    alignas(32) double electronegativity[COLUMN_CAPACITY];
+    alignas(32) double ionizationEnergy[COLUMN_CAPACITY];  // eV
+    alignas(32) double density[COLUMN_CAPACITY];           // g/cm3
+    alignas(32) double meltingPoint[COLUMN_CAPACITY];      // K
+    alignas(32) double boilingPoint[COLUMN_CAPACITY];      // K
+    alignas(32) int32_t atomicNumber[COLUMN_CAPACITY];
+    alignas(32) int32_t period[COLUMN_CAPACITY];
+    alignas(32) int32_t group[COLUMN_CAPACITY];
+    alignas(32) int32_t color[COLUMN_CAPACITY];
+    alignas(32) char block[COLUMN_CAPACITY];
+    int32_t count;
+};
+
+struct ColumnStats {
+    double min;
+    double max;
+    double mean;
+    int count;  // non-missing values that took part
+};
+
+// Function to fill the columns from the element table
+void buildElementColumns(ElementColumns& columns, const Element elements[], int count);
+
+// The columns built from ELEMENTS plus the properties in the element data
+// file, or mapped from the binary snapshot (see element_data.h), created on
+// first use. A hot reload (element_reload.h) can publish a new table at any
+// time; callers should not keep the reference beyond the event or request
+// they are handling, and never for more than a few seconds.
+const ElementColumns& elementColumns();
+
+// Function to make columns the current table, atomically. Returns the
+// table it replaced, which readers may still be using.
+const ElementColumns* publishElementColumns(const ElementColumns* columns);
+
+// Counts publishes, so readers can tell the table changed (starts at 1)
+unsigned elementColumnsGeneration();
+
+const double* propertyColumn(const ElementColumns& columns, int property);
+double* propertyColumn(ElementColumns& columns, int property);
+const char* propertyName(int property);
+const char* propertyUnit(int property);
+
+// Mask helpers
+ElementMask emptyMask();
+ElementMask fullMask(int count);
+bool maskTest(const ElementMask& mask, int index);
+void maskSet(ElementMask& mask, int index);
+ElementMask maskAnd(const ElementMask& a, const ElementMask& b);
+ElementMask maskOr(const ElementMask& a, const ElementMask& b);
+ElementMask maskAndNot(const ElementMask& a, const ElementMask& b);
+bool maskEqual(const ElementMask& a, const ElementMask& b);
+int maskCount(const ElementMask& mask);
+
+// Filter kernels over a double column
+ElementMask maskGreater(const double* column, double threshold);
+ElementMask maskLess(const double* column, double threshold);
+ElementMask maskRange(const double* column, double low, double high);  // inclusive
+
+// Filter kernels over the integer and block columns
+ElementMask maskIntEquals(const int32_t* column, int value);
+ElementMask maskIntRange(const int32_t* column, int low, int high);  // inclusive
+ElementMask maskBlock(const ElementColumns& columns, char block);
+
+// Function to reduce a column to min/max/mean, optionally only over the
+// elements in filter (pass NULL for all)
+ColumnStats columnStats(const double* column, int count, const ElementMask* filter);
+
+#endif
@@ -0,0 +1,78 @@
+#include "element_compare.h"
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COMPARE_SSE2 1
+#endif
+
+void compareElements(const ElementColumns& columns, const int elements[], int count, Comparison& out) {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    if(count > MAX_COMPARE) count = MAX_COMPARE;
+    out.count = count;
+    for(int i = 0; i < MAX_COMPARE; i++) out.elements[i] = i < count ? elements[i] : -1;
+    
+    for(int p = 0; p < PROP_COUNT; p++) {
+        const double* column = propertyColumn(columns, p);
+        double* value = out.value[p];
+        double* delta = out.delta[p];
+        int* rank = out.rank[p];
+        
+        // Gather; unused lanes are NaN like the column padding
+        for(int i = 0; i < MAX_COMPARE; i++) value[i] = i < count ? column[elements[i]] : missing;
+        double reference = value[0];
+        
+#ifdef COMPARE_SSE2
+        __m128d ref = _mm_set1_pd(reference);
+        __m128d lo = _mm_set1_pd(std::numeric_limits<double>::infinity());
+        __m128d hi = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+        for(int i = 0; i < MAX_COMPARE; i += 2) {
+            __m128d v = _mm_load_pd(value + i);
+            _mm_store_pd(delta + i, _mm_sub_pd(v, ref));
+            // min/max return the second operand when either is NaN, so
+            // putting the accumulator second skips missing values
+            lo = _mm_min_pd(v, lo);
+            hi = _mm_max_pd(v, hi);
+        }
+        double lows[2], highs[2];
+        _mm_storeu_pd(lows, lo);
+        _mm_storeu_pd(highs, hi);
+        out.minValue[p] = lows[0] < lows[1] ? lows[0] : lows[1];
+        out.maxValue[p] = highs[0] > highs[1] ? highs[0] : highs[1];
+        
+        // Rank = 1 + how many values are larger; NaN lanes never compare
+        // greater, so unknown values don't push anyone down
+        for(int i = 0; i < count; i++) {
+            if(std::isnan(value[i])) {
+                rank[i] = 0;
+                continue;
+            }
+            __m128d x = _mm_set1_pd(value[i]);
+            int larger = 0;
+            for(int j = 0; j < MAX_COMPARE; j += 2) {
+                int bits = _mm_movemask_pd(_mm_cmpgt_pd(_mm_load_pd(value + j), x));
+                larger += (bits & 1) + (bits >> 1);
+            }
+            rank[i] = 1 + larger;
+        }
+#else
+        out.minValue[p] = std::numeric_limits<double>::infinity();
+        out.maxValue[p] = -std::numeric_limits<double>::infinity();
+        for(int i = 0; i < MAX_COMPARE; i++) {
+            delta[i] = value[i] - reference;
+            if(value[i] < out.minValue[p]) out.minValue[p] = value[i];
+            if(value[i] > out.maxValue[p]) out.maxValue[p] = value[i];
+        }
+        for(int i = 0; i < count; i++) {
+            rank[i] = 0;
+            if(std::isnan(value[i])) continue;
+            rank[i] = 1;
+            for(int j = 0; j < count; j++) {
+                if(value[j] > value[i]) rank[i]++;
+            }
+        }
+#endif
+        for(int i = count; i < MAX_COMPARE; i++) rank[i] = 0;
+    }
+}
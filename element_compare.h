@@ -0,0 +1,26 @@
+#ifndef ELEMENT_COMPARE_H
+#define ELEMENT_COMPARE_H
+
+#include "element_columns.h"
+
+// Side-by-side comparison of a handful of elements. compareElements gathers
+// each property of the selected elements from the columns into one short
+// vector and computes every delta, rank and range from it in a single pass,
+// a few SIMD operations per property.
+
+const int MAX_COMPARE = 8;
+
+struct Comparison {
+    int count;
+    int elements[MAX_COMPARE];                     // indexes into ELEMENTS
+    alignas(16) double value[PROP_COUNT][MAX_COMPARE];  // NaN if unknown
+    alignas(16) double delta[PROP_COUNT][MAX_COMPARE];  // versus elements[0]
+    int rank[PROP_COUNT][MAX_COMPARE];             // 1 = largest, 0 if unknown
+    double minValue[PROP_COUNT];
+    double maxValue[PROP_COUNT];
+};
+
+// Function to compare up to MAX_COMPARE elements (extra ones are ignored)
+void compareElements(const ElementColumns& columns, const int elements[], int count, Comparison& out);
+
+#endif
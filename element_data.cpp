@@ -0,0 +1,354 @@
+#include "element_data.h"
+#include "mapped_file.h"
+#include "element_snapshot.h"
+#include "timing.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+using namespace std;
+
+// Header names accepted for each property column
+struct DataColumnName {
+    const char* name;
+    int property;
+};
+
+const int COLUMN_SYMBOL = -2;
+const int COLUMN_IGNORED = -1;
+
+const DataColumnName DATA_COLUMN_NAMES[] = {
+    { "symbol", COLUMN_SYMBOL },
+    { "weight", PROP_ATOMIC_WEIGHT },
+    { "atomic_weight", PROP_ATOMIC_WEIGHT },
+    { "radius", PROP_ATOMIC_RADIUS },
+    { "atomic_radius", PROP_ATOMIC_RADIUS },
+    { "electronegativity", PROP_ELECTRONEGATIVITY },
+    { "en", PROP_ELECTRONEGATIVITY },
+    { "ionization", PROP_IONIZATION_ENERGY },
+    { "ionization_energy", PROP_IONIZATION_ENERGY },
+    { "density", PROP_DENSITY },
+    { "melting", PROP_MELTING_POINT },
+    { "melting_point", PROP_MELTING_POINT },
+    { "boiling", PROP_BOILING_POINT },
+    { "boiling_point", PROP_BOILING_POINT }
+};
+
+const int MAX_DATA_COLUMNS = 16;
+
+bool spanEquals(const Span& span, const char* text) {
+    const char* p = span.begin;
+    for(; p < span.end && *text != '\0'; p++, text++) {
+        char c = *p;
+        if(c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if(c != *text) return false;
+    }
+    return p == span.end && *text == '\0';
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Function to cut the next field off the line, trimmed of blanks. Leaves p
+// on the ',' or '\n' that ended it (or on end).
+Span nextField(const char*& p, const char* end) {
+    while(p < end && isBlank(*p)) p++;
+    Span field = { p, p };
+    while(p < end && *p != ',' && *p != '\n') p++;
+    field.end = p;
+    while(field.end > field.begin && isBlank(field.end[-1])) field.end--;
+    return field;
+}
+
+// Exact powers of ten; a mantissa below 2^53 divided or multiplied by one
+// of these rounds correctly
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Function to parse a decimal number that must fill the whole span.
+// strtod can't be used on the mapping: it needs a terminating NUL.
+bool parseNumber(const Span& span, double& out) {
+    const char* p = span.begin;
+    const char* end = span.end;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    
+    const uint64_t MANTISSA_LIMIT = 1000000000000000ULL;  // keeps it exact in a double
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for(; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if(mantissa < MANTISSA_LIMIT) mantissa = mantissa * 10 + (*p - '0');
+        else exponent++;
+    }
+    if(p < end && *p == '.') {
+        for(p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if(mantissa < MANTISSA_LIMIT) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if(digits == 0) return false;
+    
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+')) negativeExponent = *p++ == '-';
+        int value = 0;
+        int exponentDigits = 0;
+        for(; p < end && *p >= '0' && *p <= '9'; p++, exponentDigits++) {
+            if(value < 10000) value = value * 10 + (*p - '0');
+        }
+        if(exponentDigits == 0) return false;
+        exponent += negativeExponent ? -value : value;
+    }
+    if(p != end) return false;
+    
+    double value = (double)mantissa;
+    if(exponent < 0) value = -exponent <= 22 ? value / POW10[-exponent] : value * pow(10.0, exponent);
+    else if(exponent > 0) value = exponent <= 22 ? value * POW10[exponent] : value * pow(10.0, exponent);
+    out = negative ? -value : value;
+    return true;
+}
+
+// Function to find an element by a symbol span, case-sensitive
+int symbolIndex(const Span& span) {
+    size_t length = span.end - span.begin;
+    if(length < 1 || length > 2) return -1;
+    char first = span.begin[0];
+    char second = length == 2 ? span.begin[1] : '\0';
+    int index = SYMBOL_HASH.slot[symbolHash(first, second)];
+    if(index < 0) return -1;
+    if(ELEMENTS[index].symbol[0] != first || ELEMENTS[index].symbol[1] != second) return -1;
+    return index;
+}
+
+void reportDataError(DataLoadReport& report, int line, const char* message) {
+    if(report.errors == 0) {
+        report.firstErrorLine = line;
+        snprintf(report.firstError, sizeof(report.firstError), "%s", message);
+    }
+    report.errors++;
+}
+
+void parseElementData(const char* data, size_t size, ElementColumns& columns, DataLoadReport& report) {
+    const char* p = data;
+    const char* end = data + size;
+    int columnProperty[MAX_DATA_COLUMNS];
+    int columnCount = 0;
+    int symbolColumn = -1;
+    int line = 0;
+    ElementMask seen = emptyMask();
+    
+    while(p < end) {
+        line++;
+        const char* lineStart = p;
+        while(p < end && isBlank(*p)) p++;
+        if(p == end || *p == '\n' || *p == '#') {
+            while(p < end && *p != '\n') p++;
+            if(p < end) p++;
+            continue;
+        }
+        p = lineStart;
+        
+        if(columnCount == 0) {
+            // Header: map each column to a property
+            while(true) {
+                Span field = nextField(p, end);
+                if(columnCount == MAX_DATA_COLUMNS) {
+                    reportDataError(report, line, "too many columns");
+                    return;
+                }
+                int property = COLUMN_IGNORED;
+                for(const DataColumnName& name : DATA_COLUMN_NAMES) {
+                    if(spanEquals(field, name.name)) property = name.property;
+                }
+                if(property == COLUMN_SYMBOL) symbolColumn = columnCount;
+                columnProperty[columnCount++] = property;
+                if(p == end || *p == '\n') break;
+                p++;
+            }
+            if(p < end) p++;
+            if(symbolColumn < 0) {
+                reportDataError(report, line, "header has no symbol column");
+                return;
+            }
+            continue;
+        }
+        
+        // Data row: find the element first, then store the values. Numbers
+        // are parsed as the fields are cut, so each byte is looked at once.
+        double values[MAX_DATA_COLUMNS];
+        bool present[MAX_DATA_COLUMNS] = {};
+        int element = -1;
+        bool bad = false;
+        int column = 0;
+        while(true) {
+            Span field = nextField(p, end);
+            if(column < columnCount && field.begin != field.end) {
+                int property = columnProperty[column];
+                if(property == COLUMN_SYMBOL) {
+                    element = symbolIndex(field);
+                    if(element < 0) {
+                        reportDataError(report, line, "unknown symbol");
+                        bad = true;
+                    }
+                } else if(property >= 0) {
+                    if(parseNumber(field, values[column])) present[column] = true;
+                    else reportDataError(report, line, "field is not a number");
+                }
+            }
+            column++;
+            if(p == end || *p == '\n') break;
+            p++;
+        }
+        if(p < end) p++;
+        
+        if(bad) continue;
+        if(element < 0) {
+            reportDataError(report, line, "row has no symbol");
+            continue;
+        }
+        if(element >= columns.count) continue;
+        for(int c = 0; c < columnCount && c < column; c++) {
+            if(!present[c]) continue;
+            propertyColumn(columns, columnProperty[c])[element] = values[c];
+            report.values++;
+        }
+        report.rows++;
+        if(!maskTest(seen, element)) {
+            maskSet(seen, element);
+            report.elements++;
+        }
+    }
+}
+
+bool loadElementData(const char* path, ElementColumns& columns, DataLoadReport& report) {
+    report = DataLoadReport();
+    long long start = timerNow();
+    
+    MappedFile file;
+    if(!mapFile(path, file)) return false;
+    report.found = true;
+    parseElementData(file.data, file.size, columns, report);
+    unmapFile(file);
+    
+    report.loadMs = timerMs(timerNow() - start);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// The load behind elementColumns(): the binary snapshot if there is a good
+// one, otherwise the compiled table plus the text data file
+// ---------------------------------------------------------------------------
+
+static const char* dataPath = DEFAULT_ELEMENT_DATA_FILE;
+static DataLoadReport defaultReport;
+static MappedFile defaultSnapshot;  // stays mapped; the columns live in it
+
+void setElementDataPath(const char* path) {
+    dataPath = path;
+}
+
+const char* elementDataPath() {
+    return dataPath;
+}
+
+const ElementColumns* loadDefaultColumns() {
+    long long start = timerNow();
+    const ElementColumns* mapped = NULL;
+    char snapshotError[48];
+    bool opened = openSnapshot(snapshotPath(), defaultSnapshot, mapped, snapshotError, sizeof(snapshotError));
+    
+    // A snapshot built from an older data file would bring back the old
+    // values on every start, so the file's CRC must match the one recorded
+    // (openSnapshot has already checked the element table). Checksumming
+    // the few KB costs microseconds and parses nothing.
+    if(opened && !snapshotMatchesSource(defaultSnapshot, dataPath)) {
+        unmapFile(defaultSnapshot);
+        snprintf(snapshotError, sizeof(snapshotError), "stale: the data file has changed");
+        opened = false;
+    }
+    if(opened) {
+        defaultReport = DataLoadReport();
+        defaultReport.found = true;
+        defaultReport.fromSnapshot = true;
+        defaultReport.loadMs = timerMs(timerNow() - start);
+        return mapped;
+    }
+    
+    static ElementColumns columns;
+    buildElementColumns(columns, ELEMENTS, ELEMENT_COUNT);
+    loadElementData(dataPath, columns, defaultReport);
+    snprintf(defaultReport.snapshotError, sizeof(defaultReport.snapshotError), "%s", snapshotError);
+    return &columns;
+}
+
+const DataLoadReport& elementDataReport() {
+    elementColumns();  // the load happens on first use
+    return defaultReport;
+}
+
+int printDataLoadReport(const DataLoadReport& report, const char* path) {
+    if(report.fromSnapshot) {
+        cout << "element data: mapped snapshot " << snapshotPath() << " in " << report.loadMs << " ms" << endl;
+        return 0;
+    }
+    if(strcmp(report.snapshotError, "not found") != 0 && report.snapshotError[0] != '\0') {
+        cout << "element data: snapshot " << snapshotPath() << " ignored (" << report.snapshotError
+             << "); regenerate it with elemental_headless snapshot-build" << endl;
+    }
+    if(!report.found) {
+        cout << "element data: " << path << " not found; radius, electronegativity and the other"
+             << " loaded properties are missing" << endl;
+        return 1;
+    }
+    cout << "element data: " << report.rows << " rows, " << report.values << " values from "
+         << path << " in " << report.loadMs << " ms" << endl;
+    if(report.errors > 0) {
+        cout << "element data: " << report.errors << " problem(s), first on line "
+             << report.firstErrorLine << ": " << report.firstError << endl;
+    }
+    return report.errors;
+}
+
+// Plausible ranges, in the units of the data file
+struct PropertyRange {
+    int property;
+    double low;
+    double high;
+};
+
+const PropertyRange DATA_RANGES[] = {
+    { PROP_ATOMIC_WEIGHT, 1, 300 },            // u
+    { PROP_ATOMIC_RADIUS, 20, 350 },           // pm
+    { PROP_ELECTRONEGATIVITY, 0.5, 4.5 },      // Pauling
+    { PROP_IONIZATION_ENERGY, 3, 25 },         // eV
+    { PROP_DENSITY, 0.00001, 41 },             // g/cm3
+    { PROP_MELTING_POINT, 0.5, 4000 },         // K
+    { PROP_BOILING_POINT, 4, 6500 }            // K
+};
+
+int validateElementData(const ElementColumns& columns, bool printSummary) {
+    int problems = 0;
+    for(int i = 0; i < columns.count; i++) {
+        for(const PropertyRange& range : DATA_RANGES) {
+            double value = propertyColumn(columns, range.property)[i];
+            if(std::isnan(value) || (value >= range.low && value <= range.high)) continue;
+            cout << "element #" << i << " (" << ELEMENTS[i].symbol << "): "
+                 << propertyName(range.property) << " " << value << " is out of range" << endl;
+            problems++;
+        }
+        if(columns.meltingPoint[i] >= columns.boilingPoint[i]) {
+            cout << "element #" << i << " (" << ELEMENTS[i].symbol << "): melting point is not below boiling point" << endl;
+            problems++;
+        }
+    }
+    if(printSummary) cout << "validated element data: " << problems << " problem(s)" << endl;
+    return problems;
+}
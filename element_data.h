@@ -0,0 +1,87 @@
+#ifndef ELEMENT_DATA_H
+#define ELEMENT_DATA_H
+
+#include "element_columns.h"
+#include <stddef.h>
+
+// Bulk loader for the properties that are not part of the compile-time
+// element table: atomic radius, electronegativity, ionization energy,
+// density and melting/boiling point. A weight column, if present, corrects
+// the compiled atomic weights. The data file is CSV:
+//
+//   # comment
+//   symbol,radius,electronegativity,ionization,density,melting,boiling
+//   H,25,2.20,13.598,0.00008988,13.99,20.271
+//
+// The header names the columns, in any order; unknown columns are ignored
+// and an empty field leaves the value missing. Rows are matched to elements
+// by symbol. The file is memory-mapped and tokenized in a single pass
+// straight out of the mapping: fields are pointer ranges into it and
+// numbers are parsed in place, with no copies or allocation.
+
+const char* const DEFAULT_ELEMENT_DATA_FILE = "element_data.csv";
+
+struct DataLoadReport {
+    bool found;            // the file could be opened and mapped
+    int rows;              // rows applied to an element
+    int elements;          // distinct elements those rows were for
+    int values;            // property values set
+    int errors;            // rows or fields skipped as malformed
+    int firstErrorLine;
+    char firstError[64];
+    double loadMs;         // map + parse (or map + check for a snapshot)
+    bool fromSnapshot;     // columns are the mapped binary snapshot
+    char snapshotError[48];  // why the snapshot was not used
+};
+
+// Function to parse data already in memory into the property columns
+void parseElementData(const char* data, size_t size, ElementColumns& columns, DataLoadReport& report);
+
+// Function to map a data file and parse it into the property columns.
+// Returns false if the file could not be opened.
+bool loadElementData(const char* path, ElementColumns& columns, DataLoadReport& report);
+
+// The file elementColumns() loads on first use, unless the binary snapshot
+// (element_snapshot.h) is there and valid; set it before then
+void setElementDataPath(const char* path);
+const char* elementDataPath();
+
+// Function behind elementColumns(): maps the snapshot, or builds the
+// columns and loads the data file. Keeps the report.
+const ElementColumns* loadDefaultColumns();
+const DataLoadReport& elementDataReport();
+
+// Function to print the report; returns the number of problems in it
+int printDataLoadReport(const DataLoadReport& report, const char* path);
+
+// Field helpers for the data files, shared with the nuclide loader
+// (nuclide_data.h). A field is a range inside the mapped file, never copied
+// out.
+struct Span {
+    const char* begin;
+    const char* end;
+};
+
+bool isBlank(char c);
+
+// Function to cut the next field off the line, trimmed of blanks. Leaves p
+// on the ',' or '\n' that ended it (or on end).
+Span nextField(const char*& p, const char* end);
+
+// Function to compare a field with lowercase text, ignoring case
+bool spanEquals(const Span& span, const char* text);
+
+// Function to parse a decimal number that must fill the whole field
+bool parseNumber(const Span& span, double& out);
+
+// Function to find an element index by symbol, case-sensitive; -1 if none
+int symbolIndex(const Span& span);
+
+// Function to count a problem, keeping the first one's line and message
+void reportDataError(DataLoadReport& report, int line, const char* message);
+
+// Function to sanity-check loaded values (ranges, melting below boiling);
+// prints each problem and returns how many there were
+int validateElementData(const ElementColumns& columns, bool printSummary = true);
+
+#endif
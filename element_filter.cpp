@@ -0,0 +1,422 @@
+#include "element_filter.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+enum FilterNodeKind {
+    NODE_COMPARE,
+    NODE_AND,
+    NODE_OR,
+    NODE_NOT
+};
+
+enum FilterField {
+    FIELD_BLOCK,
+    FIELD_WEIGHT,
+    FIELD_RADIUS,
+    FIELD_ELECTRONEGATIVITY,
+    FIELD_IONIZATION,
+    FIELD_DENSITY,
+    FIELD_MELTING,
+    FIELD_BOILING,
+    FIELD_CATEGORY,
+    FIELD_PERIOD,
+    FIELD_GROUP,
+    FIELD_NUMBER
+};
+
+enum FilterOp {
+    OP_EQUAL,
+    OP_NOT_EQUAL,
+    OP_LESS,
+    OP_LESS_EQUAL,
+    OP_GREATER,
+    OP_GREATER_EQUAL
+};
+
+struct FieldName {
+    const char* name;
+    int field;
+};
+
+static const FieldName fieldNames[] = {
+    { "block", FIELD_BLOCK },
+    { "weight", FIELD_WEIGHT },
+    { "atomicweight", FIELD_WEIGHT },
+    { "radius", FIELD_RADIUS },
+    { "atomicradius", FIELD_RADIUS },
+    { "en", FIELD_ELECTRONEGATIVITY },
+    { "electronegativity", FIELD_ELECTRONEGATIVITY },
+    { "ie", FIELD_IONIZATION },
+    { "ionization", FIELD_IONIZATION },
+    { "density", FIELD_DENSITY },
+    { "mp", FIELD_MELTING },
+    { "melting", FIELD_MELTING },
+    { "bp", FIELD_BOILING },
+    { "boiling", FIELD_BOILING },
+    { "category", FIELD_CATEGORY },
+    { "color", FIELD_CATEGORY },
+    { "period", FIELD_PERIOD },
+    { "group", FIELD_GROUP },
+    { "number", FIELD_NUMBER },
+    { "z", FIELD_NUMBER },
+    { "atomicnumber", FIELD_NUMBER }
+};
+
+struct CategoryName {
+    const char* name;
+    int color;
+};
+
+static const CategoryName categoryNames[] = {
+    { "alkali", ALKALI_METAL },
+    { "alkaline", ALKALINE_EARTH },
+    { "transition", TRANSITION_METAL },
+    { "post-transition", POST_TRANSITION },
+    { "metalloid", METALLOID },
+    { "nonmetal", NONMETAL },
+    { "noble", NOBLE_GAS },
+    { "lanthanide", LANTHANIDE },
+    { "actinide", ACTINIDE }
+};
+
+// ---------------------------------------------------------------------------
+// Parser: recursive descent straight over the text
+//
+//   expr       := term ('|' term)*
+//   term       := factor ('&' factor)*
+//   factor     := '!' factor | '(' expr ')' | field op value
+// ---------------------------------------------------------------------------
+
+struct FilterParser {
+    const char* at;
+    ElementFilter* filter;
+    bool failed;
+};
+
+static void fail(FilterParser& p, const char* message) {
+    if(!p.failed) {
+        snprintf(p.filter->error, sizeof(p.filter->error), "%s", message);
+        p.failed = true;
+    }
+}
+
+static void skipSpace(FilterParser& p) {
+    while(isspace((unsigned char)*p.at)) p.at++;
+}
+
+// Function to read an identifier into word (lower-cased); returns its length
+static int readWord(FilterParser& p, char* word, int size) {
+    skipSpace(p);
+    int length = 0;
+    while(isalnum((unsigned char)*p.at) || *p.at == '-' || *p.at == '_') {
+        if(length < size - 1) word[length++] = (char)tolower((unsigned char)*p.at);
+        p.at++;
+    }
+    word[length] = '\0';
+    return length;
+}
+
+// Function to consume a keyword ("and", "or", "not") if it comes next
+static bool acceptKeyword(FilterParser& p, const char* keyword) {
+    skipSpace(p);
+    int length = strlen(keyword);
+    for(int i = 0; i < length; i++) {
+        if(tolower((unsigned char)p.at[i]) != keyword[i]) return false;
+    }
+    if(isalnum((unsigned char)p.at[length])) return false;
+    p.at += length;
+    return true;
+}
+
+static bool accept(FilterParser& p, char c) {
+    skipSpace(p);
+    if(*p.at != c) return false;
+    p.at++;
+    if((c == '&' || c == '|') && *p.at == c) p.at++;  // && and || also work
+    return true;
+}
+
+static int addNode(FilterParser& p, int kind, int left, int right) {
+    if(p.filter->nodeCount == MAX_FILTER_NODES) {
+        fail(p, "expression too long");
+        return -1;
+    }
+    FilterNode& node = p.filter->nodes[p.filter->nodeCount];
+    memset(&node, 0, sizeof(node));
+    node.kind = kind;
+    node.left = left;
+    node.right = right;
+    return p.filter->nodeCount++;
+}
+
+static int parseExpr(FilterParser& p);
+
+static int parseComparison(FilterParser& p) {
+    char word[32];
+    if(readWord(p, word, sizeof(word)) == 0) {
+        fail(p, "expected a field name");
+        return -1;
+    }
+    
+    int field = -1;
+    for(unsigned i = 0; i < sizeof(fieldNames) / sizeof(fieldNames[0]); i++) {
+        if(strcmp(word, fieldNames[i].name) == 0) field = fieldNames[i].field;
+    }
+    if(field < 0) {
+        fail(p, "unknown field");
+        return -1;
+    }
+    
+    skipSpace(p);
+    int op;
+    if(p.at[0] == '!' && p.at[1] == '=') { op = OP_NOT_EQUAL; p.at += 2; }
+    else if(p.at[0] == '<' && p.at[1] == '=') { op = OP_LESS_EQUAL; p.at += 2; }
+    else if(p.at[0] == '>' && p.at[1] == '=') { op = OP_GREATER_EQUAL; p.at += 2; }
+    else if(p.at[0] == '=' && p.at[1] == '=') { op = OP_EQUAL; p.at += 2; }
+    else if(p.at[0] == '=') { op = OP_EQUAL; p.at++; }
+    else if(p.at[0] == '<') { op = OP_LESS; p.at++; }
+    else if(p.at[0] == '>') { op = OP_GREATER; p.at++; }
+    else {
+        fail(p, "expected = != < <= > >=");
+        return -1;
+    }
+    
+    int index = addNode(p, NODE_COMPARE, -1, -1);
+    if(index < 0) return -1;
+    FilterNode& node = p.filter->nodes[index];
+    node.field = field;
+    node.op = op;
+    
+    if(field == FIELD_BLOCK || field == FIELD_CATEGORY) {
+        if(op != OP_EQUAL && op != OP_NOT_EQUAL) {
+            fail(p, "block and category only support = and !=");
+            return -1;
+        }
+        if(readWord(p, word, sizeof(word)) == 0) {
+            fail(p, "expected a value");
+            return -1;
+        }
+        if(field == FIELD_BLOCK) {
+            if(word[1] != '\0' || strchr("spdf", word[0]) == NULL) {
+                fail(p, "block must be s, p, d or f");
+                return -1;
+            }
+            node.block = word[0];
+            return index;
+        }
+        for(unsigned i = 0; i < sizeof(categoryNames) / sizeof(categoryNames[0]); i++) {
+            if(strcmp(word, categoryNames[i].name) == 0) node.number = categoryNames[i].color;
+        }
+        if(node.number == 0) {
+            fail(p, "unknown category");
+            return -1;
+        }
+        return index;
+    }
+    
+    skipSpace(p);
+    char* end;
+    node.number = strtod(p.at, &end);
+    if(end == p.at) {
+        fail(p, "expected a number");
+        return -1;
+    }
+    if(!std::isfinite(node.number)) {
+        fail(p, "number out of range");  // nan, inf or past the double range
+        return -1;
+    }
+    p.at = end;
+    return index;
+}
+
+static int parseFactor(FilterParser& p) {
+    if(accept(p, '!') || acceptKeyword(p, "not")) {
+        int operand = parseFactor(p);
+        return p.failed ? -1 : addNode(p, NODE_NOT, operand, -1);
+    }
+    if(accept(p, '(')) {
+        int inner = parseExpr(p);
+        if(!p.failed && !accept(p, ')')) fail(p, "missing )");
+        return inner;
+    }
+    return parseComparison(p);
+}
+
+static int parseTerm(FilterParser& p) {
+    int left = parseFactor(p);
+    while(!p.failed && (accept(p, '&') || acceptKeyword(p, "and"))) {
+        int right = parseFactor(p);
+        left = addNode(p, NODE_AND, left, right);
+    }
+    return left;
+}
+
+static int parseExpr(FilterParser& p) {
+    int left = parseTerm(p);
+    while(!p.failed && (accept(p, '|') || acceptKeyword(p, "or"))) {
+        int right = parseTerm(p);
+        left = addNode(p, NODE_OR, left, right);
+    }
+    return left;
+}
+
+bool parseFilter(const char* text, ElementFilter& filter) {
+    filter.nodeCount = 0;
+    filter.root = -1;
+    filter.error[0] = '\0';
+    
+    FilterParser p = { text, &filter, false };
+    skipSpace(p);
+    if(*p.at == '\0') return true;
+    
+    int root = parseExpr(p);
+    skipSpace(p);
+    if(!p.failed && *p.at != '\0') fail(p, "unexpected text after expression");
+    if(p.failed) return false;
+    
+    filter.root = root;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation: each comparison is one column kernel call
+// ---------------------------------------------------------------------------
+
+static ElementMask compareDoubles(const double* column, int op, double value) {
+    double inf = std::numeric_limits<double>::infinity();
+    switch(op) {
+        case OP_EQUAL: return maskRange(column, value, value);
+        case OP_LESS: return maskLess(column, value);
+        case OP_LESS_EQUAL: return maskRange(column, -inf, value);
+        case OP_GREATER: return maskGreater(column, value);
+        case OP_GREATER_EQUAL: return maskRange(column, value, inf);
+        default:
+            // Missing values match neither = nor !=
+            return maskAndNot(maskRange(column, -inf, inf), maskRange(column, value, value));
+    }
+}
+
+static ElementMask compareInts(const int32_t* column, int count, int op, double value) {
+    // Integer fields compare as whole numbers: the bound is rounded toward
+    // the values it admits, in doubles, and only converted once it is known
+    // to lie in the int range. No whole number equals a fraction.
+    const double INT_LIMIT = 2147483647.0;
+    double low = -INT_LIMIT;
+    double high = INT_LIMIT;
+    switch(op) {
+        case OP_EQUAL:
+        case OP_NOT_EQUAL: low = high = value == floor(value) ? value : NAN; break;
+        case OP_LESS: high = ceil(value) - 1; break;
+        case OP_LESS_EQUAL: high = floor(value); break;
+        case OP_GREATER: low = floor(value) + 1; break;
+        case OP_GREATER_EQUAL: low = ceil(value); break;
+    }
+    
+    ElementMask mask = emptyMask();
+    if(low <= high && low <= INT_LIMIT && high >= -INT_LIMIT) {
+        int lowInt = (int)fmax(low, -INT_LIMIT);
+        int highInt = (int)fmin(high, INT_LIMIT);
+        mask = maskAnd(maskIntRange(column, lowInt, highInt), fullMask(count));
+    }
+    if(op == OP_NOT_EQUAL) mask = maskAndNot(fullMask(count), mask);
+    return mask;
+}
+
+static ElementMask evaluateNode(const ElementFilter& filter, int index, const ElementColumns& columns) {
+    const FilterNode& node = filter.nodes[index];
+    ElementMask all = fullMask(columns.count);
+    
+    switch(node.kind) {
+        case NODE_AND:
+            return maskAnd(evaluateNode(filter, node.left, columns), evaluateNode(filter, node.right, columns));
+        case NODE_OR:
+            return maskOr(evaluateNode(filter, node.left, columns), evaluateNode(filter, node.right, columns));
+        case NODE_NOT:
+            return maskAndNot(all, evaluateNode(filter, node.left, columns));
+    }
+    
+    ElementMask mask;
+    switch(node.field) {
+        case FIELD_BLOCK:
+            mask = maskBlock(columns, node.block);
+            return node.op == OP_NOT_EQUAL ? maskAndNot(all, mask) : mask;
+        case FIELD_CATEGORY:
+            mask = maskIntEquals(columns.color, (int)node.number);
+            return node.op == OP_NOT_EQUAL ? maskAndNot(all, mask) : mask;
+        case FIELD_WEIGHT:
+            return compareDoubles(columns.atomicWeight, node.op, node.number);
+        case FIELD_RADIUS:
+            return compareDoubles(columns.atomicRadius, node.op, node.number);
+        case FIELD_ELECTRONEGATIVITY:
+            return compareDoubles(columns.electronegativity, node.op, node.number);
+        case FIELD_IONIZATION:
+            return compareDoubles(columns.ionizationEnergy, node.op, node.number);
+        case FIELD_DENSITY:
+            return compareDoubles(columns.density, node.op, node.number);
+        case FIELD_MELTING:
+            return compareDoubles(columns.meltingPoint, node.op, node.number);
+        case FIELD_BOILING:
+            return compareDoubles(columns.boilingPoint, node.op, node.number);
+        case FIELD_PERIOD:
+            return compareInts(columns.period, columns.count, node.op, node.number);
+        case FIELD_GROUP:
+            return compareInts(columns.group, columns.count, node.op, node.number);
+        default:
+            return compareInts(columns.atomicNumber, columns.count, node.op, node.number);
+    }
+}
+
+ElementMask evaluateFilter(const ElementFilter& filter, const ElementColumns& columns) {
+    if(filter.root < 0) return fullMask(columns.count);
+    return evaluateNode(filter, filter.root, columns);
+}
+
+// Expressions with the number of elements each must match, or -1 if it
+// must not parse
+struct FilterCheck {
+    const char* text;
+    int matches;
+};
+
+static const FilterCheck FILTER_CHECKS[] = {
+    { "number=2", 1 },
+    { "number=2.5", 0 },
+    { "number!=2.5", ELEMENT_COUNT },
+    { "number<2.5", 2 },
+    { "number<=2.5", 2 },
+    { "number>2.5", ELEMENT_COUNT - 2 },
+    { "number>=2.5", ELEMENT_COUNT - 2 },
+    { "number<3", 2 },
+    { "number>-0.5", ELEMENT_COUNT },
+    { "number>1e300", 0 },
+    { "number<1e300", ELEMENT_COUNT },
+    { "number<=-1e300", 0 },
+    { "number=1e300", 0 },
+    { "number!=1e300", ELEMENT_COUNT },
+    { "period>=2147483648", 0 },
+    { "group<-2147483648", 0 },
+    { "number>nan", -1 },
+    { "number<inf", -1 },
+    { "number<1e999", -1 },
+};
+
+int validateFilterParser(const ElementColumns& columns) {
+    int problems = 0;
+    int count = (int)(sizeof(FILTER_CHECKS) / sizeof(FILTER_CHECKS[0]));
+    for(int c = 0; c < count; c++) {
+        const FilterCheck& check = FILTER_CHECKS[c];
+        ElementFilter filter;
+        bool parsed = parseFilter(check.text, filter);
+        int matches = parsed ? maskCount(evaluateFilter(filter, columns)) : -1;
+        if(matches == check.matches) continue;
+        if(parsed) printf("filter %s: expected %d matches, got %d\n", check.text, check.matches, matches);
+        else printf("filter %s: expected %d matches, got \"%s\"\n", check.text, check.matches, filter.error);
+        problems++;
+    }
+    printf("checked %d filters: %d problem(s)\n", count, problems);
+    return problems;
+}
@@ -0,0 +1,49 @@
+#ifndef ELEMENT_FILTER_H
+#define ELEMENT_FILTER_H
+
+#include "element_columns.h"
+
+// Small predicate language over element properties, evaluated with the
+// column kernels into an ElementMask. Examples:
+//
+//   block=d & weight>50
+//   category=noble | (period=2 & en>=3)
+//   !block=f
+//
+// Fields: block, weight, radius, en (electronegativity), ie (ionization
+// energy, eV), density, mp and bp (melting and boiling point, K), category,
+// period, group, number. Operators: = != < <= > >=, combined with & (and), | (or),
+// ! (not) and parentheses. Category values: alkali, alkaline, transition,
+// post-transition, metalloid, nonmetal, noble, lanthanide, actinide.
+
+const int MAX_FILTER_NODES = 64;
+
+struct FilterNode {
+    int kind;
+    int field;
+    int op;
+    double number;
+    char block;
+    int left;
+    int right;
+};
+
+struct ElementFilter {
+    FilterNode nodes[MAX_FILTER_NODES];
+    int nodeCount;
+    int root;            // -1 for an empty filter, which matches everything
+    char error[64];
+};
+
+// Function to parse a filter expression. Returns false and fills
+// filter.error if the text is not a complete expression.
+bool parseFilter(const char* text, ElementFilter& filter);
+
+// Function to evaluate a parsed filter over the columns
+ElementMask evaluateFilter(const ElementFilter& filter, const ElementColumns& columns);
+
+// Function to run a fixed list of expressions, limits included, and check
+// how many elements each matches. Prints each problem and returns the count.
+int validateFilterParser(const ElementColumns& columns);
+
+#endif
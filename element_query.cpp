@@ -0,0 +1,146 @@
+#include "element_query.h"
+#include "electron_config.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+// Function to check if mouse click is inside element box 
+bool isClickInElement(int mouseX, int mouseY, const Element& elem) {
+    return (mouseX >= elem.x && mouseX <= elem.x + boxSize &&
+            mouseY >= elem.y && mouseY <= elem.y + boxSize);
+}
+
+// Lookup grid for hit-testing: one slot per table cell holding an index into
+// the element array, or -1 for the gaps (e.g. between H and He)
+static int hitGrid[GRID_ROWS][GRID_COLS];
+
+void buildHitGrid(const Element elements[], int count) {
+    for(int row = 0; row < GRID_ROWS; row++) {
+        for(int col = 0; col < GRID_COLS; col++) {
+            hitGrid[row][col] = -1;
+        }
+    }
+    
+    for(int i = 0; i < count; i++) {
+        const Element& elem = elements[i];
+        int dx = elem.x - baseX;
+        int dy = elem.y - baseY;
+        if(dx < 0 || dy < 0 || dx % boxSize != 0 || dy % boxSize != 0) continue;
+        
+        int col = dx / boxSize;
+        int row = dy / boxSize;
+        if(row >= GRID_ROWS || col >= GRID_COLS) continue;
+        hitGrid[row][col] = i;
+    }
+}
+
+// Function to look up a grid slot, -1 when outside the grid or empty
+static int hitGridAt(int row, int col) {
+    if(row < 0 || col < 0 || row >= GRID_ROWS || col >= GRID_COLS) return -1;
+    return hitGrid[row][col];
+}
+
+int elementAt(const Element elements[], int mouseX, int mouseY) {
+    if(mouseX < baseX || mouseY < baseY) return -1;
+    
+    int col = (mouseX - baseX) / boxSize;
+    int row = (mouseY - baseY) / boxSize;
+    
+    int index = hitGridAt(row, col);
+    if(index >= 0 && isClickInElement(mouseX, mouseY, elements[index])) return index;
+    
+    // Bounding-box fallback: a box includes its right and bottom edge, so a
+    // point on a cell boundary may belong to the cell left of or above it
+    const int neighbours[3][2] = { {0, -1}, {-1, 0}, {-1, -1} };
+    for(int n = 0; n < 3; n++) {
+        index = hitGridAt(row + neighbours[n][0], col + neighbours[n][1]);
+        if(index >= 0 && isClickInElement(mouseX, mouseY, elements[index])) return index;
+    }
+    return -1;
+}
+
+// Division rounding down, so points left of or above the grid stay outside it
+static int floorDiv(long long a, int b) {
+    return (int)(a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+
+int elementAt(const Element elements[], const ViewTransform& view, int x, int y) {
+    int layoutX = baseX + floorDiv((long long)(x - view.originX) * boxSize, view.cellSize);
+    int layoutY = baseY + floorDiv((long long)(y - view.originY) * boxSize, view.cellSize);
+    return elementAt(elements, layoutX, layoutY);
+}
+
+// Function to report one validation problem
+static void reportProblem(int& problems, int index, const Element& elem, const char* message) {
+    cout << "element #" << index << " (" << elem.symbol << "): " << message << endl;
+    problems++;
+}
+
+// Checks for empty fields, atomic numbers out of order, unknown categories,
+// and cells that fall outside the grid or on top of each other
+int validateElements(const Element elements[], int count) {
+    const int categoryColors[] = {
+        ALKALI_METAL, ALKALINE_EARTH, TRANSITION_METAL, POST_TRANSITION,
+        METALLOID, NONMETAL, NOBLE_GAS, LANTHANIDE, ACTINIDE
+    };
+    int owner[GRID_ROWS][GRID_COLS];
+    for(int row = 0; row < GRID_ROWS; row++) {
+        for(int col = 0; col < GRID_COLS; col++) owner[row][col] = -1;
+    }
+    
+    int problems = 0;
+    for(int i = 0; i < count; i++) {
+        const Element& elem = elements[i];
+        
+        if(elem.symbol[0] == '\0') reportProblem(problems, i, elem, "empty symbol");
+        if(elem.name[0] == '\0') reportProblem(problems, i, elem, "empty name");
+        if(elem.electronConfig[0] == '\0') reportProblem(problems, i, elem, "empty electron configuration");
+        if(elem.block[0] == '\0' || strchr("spdf", elem.block[0]) == NULL || elem.block[1] != '\0') {
+            reportProblem(problems, i, elem, "block is not one of s, p, d, f");
+        }
+        
+        // The table lists only the electrons outside the noble-gas core;
+        // with the core added back they must match the generated ground state
+        char fullConfig[64];
+        int core = nobleCore(elem.atomicNumber);
+        if(core > 0) snprintf(fullConfig, sizeof(fullConfig), "[%s] %s", ELEMENTS[core - 1].symbol, elem.electronConfig);
+        else snprintf(fullConfig, sizeof(fullConfig), "%s", elem.electronConfig);
+        ElectronConfig parsed;
+        if(!parseElectronConfig(fullConfig, parsed)) {
+            reportProblem(problems, i, elem, "electron configuration does not parse");
+        } else if(elem.atomicNumber >= 1 && elem.atomicNumber <= ELEMENT_COUNT &&
+                  memcmp(&parsed, &groundStateConfig(elem.atomicNumber), sizeof(parsed)) != 0) {
+            reportProblem(problems, i, elem, "electron configuration differs from the Aufbau ground state");
+        }
+        
+        if(!(elem.atomicWeight > 0)) reportProblem(problems, i, elem, "atomic weight is not positive");
+        
+        if(elem.atomicNumber != i + 1) reportProblem(problems, i, elem, "atomic number does not match table position");
+        if(i > 0 && elem.atomicNumber <= elements[i - 1].atomicNumber) {
+            reportProblem(problems, i, elem, "atomic number is not greater than the previous entry");
+        }
+        if(elem.period < 1 || elem.period > 7) reportProblem(problems, i, elem, "period out of range");
+        if(elem.group < 1 || elem.group > 18) reportProblem(problems, i, elem, "group out of range");
+        
+        bool knownColor = false;
+        for(int c = 0; c < 9; c++) {
+            if(elem.color == categoryColors[c]) knownColor = true;
+        }
+        if(!knownColor) reportProblem(problems, i, elem, "color is not a legend category");
+        
+        int dx = elem.x - baseX;
+        int dy = elem.y - baseY;
+        if(dx < 0 || dy < 0 || dx % boxSize != 0 || dy % boxSize != 0 ||
+           dx / boxSize >= GRID_COLS || dy / boxSize >= GRID_ROWS) {
+            reportProblem(problems, i, elem, "cell is not on the table grid");
+            continue;
+        }
+        int& cellOwner = owner[dy / boxSize][dx / boxSize];
+        if(cellOwner >= 0) reportProblem(problems, i, elem, "cell already used by another element");
+        else cellOwner = i;
+    }
+    
+    cout << "validated " << count << " elements: " << problems << " problem(s)" << endl;
+    return problems;
+}
@@ -0,0 +1,45 @@
+#ifndef ELEMENT_QUERY_H
+#define ELEMENT_QUERY_H
+
+#include "elements.h"
+
+// Hit-testing and validation over the element table
+
+bool isClickInElement(int mouseX, int mouseY, const Element& elem);
+
+// Function to build the hit-testing grid from the element positions
+void buildHitGrid(const Element elements[], int count);
+
+// Function to find the element under the mouse in constant time.
+// Returns the element index, or -1 if the point is not on any element.
+int elementAt(const Element elements[], int mouseX, int mouseY);
+
+// Zoom and pan. Element x and y are layout coordinates, boxSize apart from
+// (baseX, baseY); on screen the grid starts at (originX, originY) and its
+// cells are cellSize apart. LAYOUT_VIEW draws the table where it is laid out.
+struct ViewTransform {
+    int cellSize;
+    int originX;
+    int originY;
+};
+
+const ViewTransform LAYOUT_VIEW = { boxSize, baseX, baseY };
+
+// Layout coordinates are whole cells from the base, so these are exact
+inline int viewX(const ViewTransform& view, int layoutX) {
+    return view.originX + (layoutX - baseX) / boxSize * view.cellSize;
+}
+
+inline int viewY(const ViewTransform& view, int layoutY) {
+    return view.originY + (layoutY - baseY) / boxSize * view.cellSize;
+}
+
+// Function to find the element under a screen point of a zoomed or panned
+// table: the point is taken back to layout coordinates and looked up there
+int elementAt(const Element elements[], const ViewTransform& view, int x, int y);
+
+// Function to check every element entry, printing each problem found.
+// Returns the number of problems.
+int validateElements(const Element elements[], int count);
+
+#endif
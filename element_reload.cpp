@@ -0,0 +1,197 @@
+#include "element_reload.h"
+#include "element_data.h"
+#include "timing.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+const int SETTLE_MS = 100;      // quiet time after the last change before reloading
+const int POLL_MS = 250;        // how often the thread checks for stop (and, without inotify, the file)
+const int RETAINED_TABLES = 4;  // published tables kept intact for readers still holding them
+const int RELOAD_INTERVAL_MS = 1000;  // least time between publishes; see the table ring below
+
+static std::thread watcherThread;
+static std::atomic<bool> stopRequested(false);
+static std::mutex reloadLock;
+
+// Tables are loaded into a ring of slots, so a slot is overwritten only
+// RETAINED_TABLES reloads after it was published. Readers take no lock or
+// reference (elementColumns() is one atomic load), so what keeps them safe
+// is a hard limit on the reload rate: publishes are at least
+// RELOAD_INTERVAL_MS apart, which leaves a table intact for
+// (RETAINED_TABLES - 1) * RELOAD_INTERVAL_MS, 3 s, after it was replaced.
+// A reader must be done with a table by then; the UI, the server and the
+// batch workers hold one for a single event, request or batch. Static
+// storage also keeps the columns' alignment, which plain new does not
+// guarantee before C++17.
+static ElementColumns tables[RETAINED_TABLES];
+static int nextTable = 0;
+static std::atomic<long long> lastPublish(0);  // timerNow() of the last publish, 0 before any
+
+// Function to give the time left before the next reload may start
+static int reloadWaitMs() {
+    long long published = lastPublish.load();
+    if(published == 0) return 0;
+    double elapsed = timerMs(timerNow() - published);
+    return elapsed >= RELOAD_INTERVAL_MS ? 0 : (int)(RELOAD_INTERVAL_MS - elapsed) + 1;
+}
+
+bool reloadElementData(const char* path) {
+    std::lock_guard<std::mutex> lock(reloadLock);
+    // The watchers wait this out themselves; this covers any other caller
+    int wait = reloadWaitMs();
+    if(wait > 0) std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+    long long start = timerNow();
+    
+    ElementColumns* fresh = &tables[nextTable];
+    DataLoadReport report;
+    buildElementColumns(*fresh, ELEMENTS, ELEMENT_COUNT);
+    bool loaded = loadElementData(path, *fresh, report);
+    // A file caught part-way through a copy parses cleanly but stops short;
+    // the missing rows would otherwise be published as blank cells
+    bool complete = report.elements == fresh->count;
+    if(!loaded || report.errors > 0 || !complete || validateElementData(*fresh, false) > 0) {
+        printDataLoadReport(report, path);
+        if(loaded && !complete) {
+            cout << "element data: only " << report.elements << " of " << fresh->count
+                 << " elements have a row" << endl;
+        }
+        cout << "element data: reload of " << path << " rejected; keeping the current data" << endl;
+        return false;
+    }
+    
+    publishElementColumns(fresh);
+    nextTable = (nextTable + 1) % RETAINED_TABLES;
+    lastPublish.store(timerNow());
+    
+    cout << "element data: reloaded " << report.values << " values from " << path << " in "
+         << timerMs(timerNow() - start) << " ms" << endl;
+    return true;
+}
+
+// Function to split path into the directory to watch and the file name
+static void splitPath(const char* path, char* directory, int directorySize, const char*& name) {
+    const char* slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char* backslash = strrchr(path, '\\');
+    if(backslash != NULL && (slash == NULL || backslash > slash)) slash = backslash;
+#endif
+    if(slash == NULL) {
+        snprintf(directory, directorySize, ".");
+        name = path;
+    } else {
+        snprintf(directory, directorySize, "%.*s", (int)(slash - path), path);
+        if(directory[0] == '\0') snprintf(directory, directorySize, "/");
+        name = slash + 1;
+    }
+}
+
+#ifdef __linux__
+
+// Watches the directory rather than the file, so editors that save by
+// writing a new file and renaming it over the old one are seen too. Only
+// finished files count: a close after writing or a rename into place. A
+// creation is not watched, since a slow copy can still be writing long
+// after the settle time.
+static void watchFile(const char* path, ReloadCallback onPublish, int fd) {
+    const char* name;
+    char directory[512];
+    splitPath(path, directory, sizeof(directory), name);
+    
+    bool pending = false;
+    alignas(struct inotify_event) char buffer[4096];
+    while(!stopRequested.load()) {
+        struct pollfd watched = { fd, POLLIN, 0 };
+        int ready = poll(&watched, 1, pending ? max(SETTLE_MS, reloadWaitMs()) : POLL_MS);
+        if(ready > 0) {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            for(ssize_t offset = 0; offset < length; ) {
+                const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+                if(event->len > 0 && strcmp(event->name, name) == 0) pending = true;
+                offset += sizeof(struct inotify_event) + event->len;
+            }
+            continue;  // wait for the changes to settle
+        }
+        if(ready == 0 && pending && reloadWaitMs() == 0) {
+            pending = false;
+            if(reloadElementData(path) && onPublish != NULL) onPublish();
+        }
+    }
+    close(fd);
+}
+
+#else
+
+struct FileStamp {
+    long long size;
+    long long modified;
+};
+
+static FileStamp fileStamp(const char* path) {
+    FileStamp stamp = { -1, -1 };
+    struct stat info;
+    if(stat(path, &info) == 0) {
+        stamp.size = (long long)info.st_size;
+        stamp.modified = (long long)info.st_mtime;
+    }
+    return stamp;
+}
+
+// Polls the file's size and modification time
+static void watchFile(const char* path, ReloadCallback onPublish) {
+    FileStamp last = fileStamp(path);
+    bool pending = false;
+    while(!stopRequested.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(pending ? max(SETTLE_MS, reloadWaitMs()) : POLL_MS));
+        FileStamp now = fileStamp(path);
+        if(now.size != last.size || now.modified != last.modified) {
+            last = now;
+            pending = true;
+            continue;
+        }
+        if(pending && reloadWaitMs() == 0) {
+            pending = false;
+            if(reloadElementData(path) && onPublish != NULL) onPublish();
+        }
+    }
+}
+
+#endif
+
+bool startDataWatcher(const char* path, ReloadCallback onPublish) {
+    if(watcherThread.joinable()) return false;
+    stopRequested.store(false);
+
+#ifdef __linux__
+    const char* name;
+    char directory[512];
+    splitPath(path, directory, sizeof(directory), name);
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) return false;
+    if(inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(fd);
+        return false;
+    }
+    watcherThread = std::thread(watchFile, path, onPublish, fd);
+#else
+    watcherThread = std::thread(watchFile, path, onPublish);
+#endif
+    return true;
+}
+
+void stopDataWatcher() {
+    if(!watcherThread.joinable()) return;
+    stopRequested.store(true);
+    watcherThread.join();
+}
@@ -0,0 +1,28 @@
+#ifndef ELEMENT_RELOAD_H
+#define ELEMENT_RELOAD_H
+
+// Hot reload of the element data file. A background thread watches the
+// file (inotify on Linux; elsewhere it polls the size and modification
+// time). Once a change has settled it parses the file into a fresh table,
+// validates it, and publishes it with publishElementColumns, an atomic
+// pointer swap. A file that fails to parse or validate is reported and
+// the current table stays. Reloads are at least a second apart, however
+// often the file changes, so a replaced table stays intact for readers
+// that still hold it (see element_reload.cpp). After a publish the
+// callback runs on the watcher thread so the UI can be woken to pick up
+// the change; file I/O and parsing never happen on the UI thread.
+
+typedef void (*ReloadCallback)();
+
+// Function to start watching path; returns false if the watcher could not
+// be started. onPublish may be NULL.
+bool startDataWatcher(const char* path, ReloadCallback onPublish);
+
+// Function to stop the watcher thread and wait for it
+void stopDataWatcher();
+
+// Function to reload path on the calling thread, as the watcher does:
+// parse, validate, publish. Returns true if a new table was published.
+bool reloadElementData(const char* path);
+
+#endif
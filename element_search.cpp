@@ -0,0 +1,98 @@
+#include "element_search.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+int findSymbol(const char* symbol) {
+    if(!isalpha((unsigned char)symbol[0])) return -1;
+    char first = (char)toupper((unsigned char)symbol[0]);
+    char second = (char)tolower((unsigned char)symbol[1]);
+    if(second != '\0' && (!isalpha((unsigned char)second) || symbol[2] != '\0')) return -1;
+    
+    int index = SYMBOL_HASH.slot[symbolHash(first, second)];
+    if(index < 0) return -1;
+    if(ELEMENTS[index].symbol[0] != first || ELEMENTS[index].symbol[1] != second) return -1;
+    return index;
+}
+
+// ---------------------------------------------------------------------------
+// Prefix trie over lower-cased names and symbols
+// ---------------------------------------------------------------------------
+
+const int TRIE_ALPHABET = 26;
+const int MAX_TRIE_NODES = 1024;
+
+struct TrieNode {
+    short child[TRIE_ALPHABET];  // 0 = no child (node 0 is the root)
+    ElementMask matches;         // every element with this prefix
+};
+
+struct SearchIndex {
+    TrieNode nodes[MAX_TRIE_NODES];
+    int nodeCount;
+};
+
+// Function to add one word to the trie, marking index on every node it passes
+static void insertWord(SearchIndex& trie, const char* word, int index) {
+    int node = 0;
+    maskSet(trie.nodes[0].matches, index);
+    for(const char* c = word; *c; c++) {
+        if(!isalpha((unsigned char)*c)) continue;
+        int letter = tolower((unsigned char)*c) - 'a';
+        if(trie.nodes[node].child[letter] == 0) {
+            if(trie.nodeCount == MAX_TRIE_NODES) abort();  // raise MAX_TRIE_NODES
+            trie.nodes[node].child[letter] = (short)trie.nodeCount++;
+        }
+        node = trie.nodes[node].child[letter];
+        maskSet(trie.nodes[node].matches, index);
+    }
+}
+
+static SearchIndex* buildSearchIndex() {
+    SearchIndex* trie = new SearchIndex();
+    trie->nodeCount = 1;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        insertWord(*trie, ELEMENTS[i].name, i);
+        insertWord(*trie, ELEMENTS[i].symbol, i);
+    }
+    return trie;
+}
+
+// The trie is built on first use; thread-safe like elementColumns()
+static const SearchIndex& searchIndex() {
+    static const SearchIndex* trie = buildSearchIndex();
+    return *trie;
+}
+
+ElementMask searchElements(const char* prefix) {
+    if(isdigit((unsigned char)prefix[0])) {
+        ElementMask mask = emptyMask();
+        char* end;
+        long number = strtol(prefix, &end, 10);
+        if(*end == '\0' && number >= 1 && number <= ELEMENT_COUNT) maskSet(mask, (int)number - 1);
+        return mask;
+    }
+    
+    const SearchIndex& trie = searchIndex();
+    int node = 0;
+    for(const char* c = prefix; *c; c++) {
+        if(!isalpha((unsigned char)*c)) return emptyMask();
+        node = trie.nodes[node].child[tolower((unsigned char)*c) - 'a'];
+        if(node == 0) return emptyMask();
+    }
+    return trie.nodes[node].matches;
+}
+
+int bestSearchMatch(const char* query) {
+    int index = findSymbol(query);
+    if(index >= 0) return index;
+    
+    ElementMask mask = searchElements(query);
+    int only = -1;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(!maskTest(mask, i)) continue;
+        if(strlen(query) == strlen(ELEMENTS[i].name)) return i;  // the prefix is the whole name
+        only = only < 0 ? i : ELEMENT_COUNT;
+    }
+    return only < ELEMENT_COUNT ? only : -1;
+}
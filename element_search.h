@@ -0,0 +1,27 @@
+#ifndef ELEMENT_SEARCH_H
+#define ELEMENT_SEARCH_H
+
+#include "elements.h"
+#include "element_columns.h"
+
+// Element lookup by symbol, name or atomic number.
+//
+// findSymbol is an exact, case-insensitive symbol lookup through the
+// compile-time perfect hash in elements.h. searchElements matches a prefix
+// against every name and symbol through a trie whose nodes each carry the
+// mask of elements below them, so a keystroke costs one child step per
+// character typed and no string comparisons.
+
+// Function to look up an element by its exact symbol; returns its index or -1
+int findSymbol(const char* symbol);
+
+// Function to find the elements whose name or symbol starts with prefix
+// (case-insensitive). An all-digit query matches that atomic number; an
+// empty query matches everything.
+ElementMask searchElements(const char* prefix);
+
+// Function to pick the element a query most likely means: an exact symbol,
+// then an exact name, then the only match. Returns -1 if that is ambiguous.
+int bestSearchMatch(const char* query);
+
+#endif
@@ -0,0 +1,549 @@
+#include "element_server.h"
+#include "query_stream.h"
+#include "element_search.h"
+#include "element_filter.h"
+#include "chemical_formula.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+static std::atomic<long long> requestCount(0);
+static int boundPort = 0;
+
+int elementServerPort() {
+    return boundPort;
+}
+
+long long elementServerRequests() {
+    return requestCount.load();
+}
+
+#ifdef __linux__
+
+const int REQUEST_BUFFER = 4096;   // one request's headers must fit
+const int RESPONSE_BUFFER = 4096;  // generated headers and bodies
+const int MAX_RESPONSE_PARTS = 2 * ELEMENT_COUNT + 4;  // well under IOV_MAX
+const int MAX_ELEMENT_RESPONSE = 768;
+const int MAX_TEXT = 1024;         // a decoded path segment or parameter
+const int EPOLL_BATCH = 64;
+const int STOP_POLL_MS = 100;      // how often workers check for stop
+
+// ---------------------------------------------------------------------------
+// Responses serialized at startup
+// ---------------------------------------------------------------------------
+
+struct ResponseCache {
+    char element[ELEMENT_COUNT][MAX_ELEMENT_RESPONSE];  // whole HTTP response
+    int elementLength[ELEMENT_COUNT];
+    int elementBody[ELEMENT_COUNT];                     // offset of the JSON object
+    char all[ELEMENT_COUNT * MAX_ELEMENT_RESPONSE];     // /elements
+    int allLength;
+    int allBody;                                        // offset of the JSON array
+};
+
+static ResponseCache cache;
+
+static const char SEPARATOR[] = ",";
+static const char FILTER_END[] = "]}";
+
+// Function to write the status line and headers for a JSON body
+static int formatHeaders(char* out, int size, int status, int contentLength, bool close) {
+    const char* reason = "OK";
+    if(status == 400) reason = "Bad Request";
+    if(status == 404) reason = "Not Found";
+    if(status == 405) reason = "Method Not Allowed";
+    if(status == 431) reason = "Request Header Fields Too Large";
+    return snprintf(out, size, "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %d\r\n%s\r\n",
+                    status, reason, contentLength, close ? "Connection: close\r\n" : "");
+}
+
+static void buildResponseCache(const ElementColumns& columns) {
+    char body[MAX_ELEMENT_RESPONSE];
+    int allBody = 0;
+    char* all = cache.all + 128;  // room for the headers, moved up against the body below
+    all[allBody++] = '[';
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        body[0] = '{';
+        int length = 1 + formatElementJson(body + 1, sizeof(body) - 2, columns, i);
+        body[length++] = '}';
+        
+        int headers = formatHeaders(cache.element[i], MAX_ELEMENT_RESPONSE, 200, length, false);
+        memcpy(cache.element[i] + headers, body, length);
+        cache.elementLength[i] = headers + length;
+        cache.elementBody[i] = headers;
+        
+        if(i > 0) all[allBody++] = ',';
+        memcpy(all + allBody, body, length);
+        allBody += length;
+    }
+    all[allBody++] = ']';
+
+    char headers[128];
+    int headerLength = formatHeaders(headers, sizeof(headers), 200, allBody, false);
+    memmove(cache.all + headerLength, all, allBody);
+    memcpy(cache.all, headers, headerLength);
+    cache.allLength = headerLength + allBody;
+    cache.allBody = headerLength;
+}
+
+// ---------------------------------------------------------------------------
+// Connections
+// ---------------------------------------------------------------------------
+
+struct Connection {
+    int fd;
+    int inUsed;
+    bool closeAfterWrite;
+    bool writing;                // registered for EPOLLOUT rather than EPOLLIN
+    int partCount;
+    int partNext;
+    Connection* prev;            // the owning worker's list
+    Connection* next;
+    struct iovec parts[MAX_RESPONSE_PARTS];
+    char in[REQUEST_BUFFER];
+    char out[RESPONSE_BUFFER];
+};
+
+struct Worker {
+    int epoll;
+    Connection* connections;
+    std::thread thread;
+};
+
+static Worker workers[MAX_SERVER_WORKERS];
+static int workerCount = 0;
+static int listenSocket = -1;
+static std::atomic<bool> stopRequested(false);
+
+static void queuePart(Connection& conn, const char* data, int length) {
+    conn.parts[conn.partCount].iov_base = (void*)data;
+    conn.parts[conn.partCount].iov_len = (size_t)length;
+    conn.partCount++;
+}
+
+// Function to queue a generated JSON response built in conn.out
+static void queueJson(Connection& conn, int status, const char* body, int length) {
+    int headers = formatHeaders(conn.out, RESPONSE_BUFFER, status, length, conn.closeAfterWrite);
+    if(headers + length > RESPONSE_BUFFER) length = RESPONSE_BUFFER - headers;  // bodies built here are far smaller
+    memcpy(conn.out + headers, body, length);
+    queuePart(conn, conn.out, headers + length);
+}
+
+static void queueError(Connection& conn, int status, const char* message) {
+    char body[160];
+    int length = snprintf(body, sizeof(body), "{\"error\":\"");
+    for(const char* p = message; *p != '\0' && length < (int)sizeof(body) - 4; p++) {
+        if(*p == '"' || *p == '\\') body[length++] = '\\';
+        body[length++] = *p;
+    }
+    length += snprintf(body + length, sizeof(body) - length, "\"}");
+    queueJson(conn, status, body, length);
+}
+
+static int hexValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Function to decode %XX and + into out, NUL-terminated. Returns false if
+// it does not fit.
+static bool urlDecode(const char* text, int length, char* out, int size) {
+    int n = 0;
+    for(int i = 0; i < length; i++) {
+        if(n == size - 1) return false;
+        char c = text[i];
+        if(c == '+') {
+            c = ' ';
+        } else if(c == '%' && i + 2 < length && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            c = (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        }
+        out[n++] = c;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+// Function to find name=value in a query string and decode the value
+static bool queryParameter(const char* query, int length, const char* name, char* out, int size) {
+    int nameLength = (int)strlen(name);
+    const char* end = query + length;
+    for(const char* p = query; p < end; ) {
+        const char* amp = (const char*)memchr(p, '&', end - p);
+        if(amp == NULL) amp = end;
+        if(amp - p > nameLength && memcmp(p, name, nameLength) == 0 && p[nameLength] == '=') {
+            return urlDecode(p + nameLength + 1, (int)(amp - p - nameLength - 1), out, size);
+        }
+        p = amp + 1;
+    }
+    return false;
+}
+
+static bool startsWith(const char* text, int length, const char* prefix) {
+    int prefixLength = (int)strlen(prefix);
+    return length >= prefixLength && memcmp(text, prefix, prefixLength) == 0;
+}
+
+// Function to answer a GET for target
+static void route(Connection& conn, const char* target, int length) {
+    const char* question = (const char*)memchr(target, '?', length);
+    int pathLength = question != NULL ? (int)(question - target) : length;
+    const char* query = question != NULL ? question + 1 : target + length;
+    int queryLength = (int)(target + length - query);
+    char text[MAX_TEXT];
+
+    if(pathLength == 9 && memcmp(target, "/elements", 9) == 0) {
+        if(conn.closeAfterWrite) {
+            // The cached headers don't say the connection closes; the body is too big for conn.out
+            int bodyLength = cache.allLength - cache.allBody;
+            int headers = formatHeaders(conn.out, RESPONSE_BUFFER, 200, bodyLength, true);
+            queuePart(conn, conn.out, headers);
+            queuePart(conn, cache.all + cache.allBody, bodyLength);
+        } else {
+            queuePart(conn, cache.all, cache.allLength);
+        }
+    } else if(startsWith(target, pathLength, "/element/")) {
+        int index = -1;
+        if(urlDecode(target + 9, pathLength - 9, text, sizeof(text)) && text[0] != '\0') index = bestSearchMatch(text);
+        if(index < 0) queueError(conn, 404, "no single element matches");
+        else if(conn.closeAfterWrite) queueJson(conn, 200, cache.element[index] + cache.elementBody[index],
+                                                cache.elementLength[index] - cache.elementBody[index]);
+        else queuePart(conn, cache.element[index], cache.elementLength[index]);
+    } else if(pathLength == 7 && memcmp(target, "/filter", 7) == 0) {
+        if(!queryParameter(query, queryLength, "q", text, sizeof(text))) text[0] = '\0';
+        ElementFilter filter;
+        if(!parseFilter(text, filter)) {
+            queueError(conn, 400, filter.error);
+            return;
+        }
+        ElementMask mask = evaluateFilter(filter, elementColumns());
+        int count = maskCount(mask);
+        
+        // Headers and the opening in conn.out, then each element's cached body
+        char opening[48];
+        int openingLength = snprintf(opening, sizeof(opening), "{\"count\":%d,\"elements\":[", count);
+        int contentLength = openingLength + (int)sizeof(FILTER_END) - 1 + (count > 0 ? count - 1 : 0);
+        for(int i = 0; i < ELEMENT_COUNT; i++) {
+            if(maskTest(mask, i)) contentLength += cache.elementLength[i] - cache.elementBody[i];
+        }
+        int headers = formatHeaders(conn.out, RESPONSE_BUFFER, 200, contentLength, conn.closeAfterWrite);
+        memcpy(conn.out + headers, opening, openingLength);
+        queuePart(conn, conn.out, headers + openingLength);
+        bool first = true;
+        for(int i = 0; i < ELEMENT_COUNT; i++) {
+            if(!maskTest(mask, i)) continue;
+            if(!first) queuePart(conn, SEPARATOR, 1);
+            queuePart(conn, cache.element[i] + cache.elementBody[i], cache.elementLength[i] - cache.elementBody[i]);
+            first = false;
+        }
+        queuePart(conn, FILTER_END, (int)sizeof(FILTER_END) - 1);
+    } else if(pathLength == 5 && memcmp(target, "/mass", 5) == 0) {
+        if(!queryParameter(query, queryLength, "formula", text, sizeof(text))) {
+            queueError(conn, 400, "missing formula parameter");
+            return;
+        }
+        FormulaResult result;
+        if(!parseFormula(text, elementColumns(), result)) {
+            char message[80];
+            snprintf(message, sizeof(message), "%s at column %d", result.error, result.errorPosition + 1);
+            queueError(conn, 400, message);
+            return;
+        }
+        char body[MAX_MASS_JSON + 8];
+        body[0] = '{';
+        int bodyLength = 1 + formatMassJson(body + 1, result);
+        body[bodyLength++] = '}';
+        queueJson(conn, 200, body, bodyLength);
+    } else {
+        queueError(conn, 404, "no such route");
+    }
+}
+
+// Function to case-insensitively compare a header name
+static bool headerIs(const char* line, int length, const char* name) {
+    int nameLength = (int)strlen(name);
+    if(length <= nameLength || line[nameLength] != ':') return false;
+    for(int i = 0; i < nameLength; i++) {
+        char c = line[i];
+        if(c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if(c != name[i]) return false;
+    }
+    return true;
+}
+
+static bool valueContains(const char* value, int length, const char* word) {
+    int wordLength = (int)strlen(word);
+    for(int i = 0; i + wordLength <= length; i++) {
+        int j = 0;
+        while(j < wordLength && (value[i + j] | 0x20) == word[j]) j++;
+        if(j == wordLength) return true;
+    }
+    return false;
+}
+
+// Function to parse one complete request (length bytes, through the blank
+// line) and queue its response
+static void handleRequest(Connection& conn, const char* request, int length) {
+    requestCount++;
+    const char* end = request + length;
+    const char* lineEnd = (const char*)memchr(request, '\r', length);
+    const char* method = request;
+    const char* space = (const char*)memchr(method, ' ', lineEnd - method);
+    const char* target = space != NULL ? space + 1 : NULL;
+    const char* space2 = target != NULL ? (const char*)memchr(target, ' ', lineEnd - target) : NULL;
+    if(space2 == NULL || !startsWith(space2 + 1, (int)(lineEnd - space2 - 1), "HTTP/1.")) {
+        conn.closeAfterWrite = true;
+        queueError(conn, 400, "malformed request line");
+        return;
+    }
+    
+    // HTTP/1.1 keeps the connection by default, 1.0 only if asked
+    bool http10 = lineEnd[-1] == '0';
+    conn.closeAfterWrite = http10;
+    bool hasBody = false;
+    for(const char* line = lineEnd + 2; line < end - 2; ) {
+        const char* next = (const char*)memchr(line, '\r', end - line);
+        int lineLength = (int)(next - line);
+        if(headerIs(line, lineLength, "connection")) {
+            if(valueContains(line, lineLength, "close")) conn.closeAfterWrite = true;
+            if(http10 && valueContains(line, lineLength, "keep-alive")) conn.closeAfterWrite = false;
+        } else if(headerIs(line, lineLength, "content-length") || headerIs(line, lineLength, "transfer-encoding")) {
+            hasBody = true;
+        }
+        line = next + 2;
+    }
+    
+    if(space - method != 3 || memcmp(method, "GET", 3) != 0) {
+        conn.closeAfterWrite = true;
+        queueError(conn, 405, "only GET is supported");
+    } else if(hasBody) {
+        conn.closeAfterWrite = true;  // the body is not read, so the stream can't continue
+        queueError(conn, 400, "request bodies are not supported");
+    } else {
+        route(conn, target, (int)(space2 - target));
+    }
+}
+
+static void closeConnection(Worker& worker, Connection* conn) {
+    close(conn->fd);  // also takes it out of the epoll set
+    if(conn->prev != NULL) conn->prev->next = conn->next;
+    else worker.connections = conn->next;
+    if(conn->next != NULL) conn->next->prev = conn->prev;
+    free(conn);
+}
+
+// Function to write as much queued output as the socket takes. Returns
+// false if the connection failed.
+static bool flushConnection(Connection& conn) {
+    while(conn.partNext < conn.partCount) {
+        ssize_t written = writev(conn.fd, conn.parts + conn.partNext, conn.partCount - conn.partNext);
+        if(written < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        while(written > 0) {
+            struct iovec& part = conn.parts[conn.partNext];
+            if((size_t)written >= part.iov_len) {
+                written -= (ssize_t)part.iov_len;
+                conn.partNext++;
+            } else {
+                part.iov_base = (char*)part.iov_base + written;
+                part.iov_len -= (size_t)written;
+                written = 0;
+            }
+        }
+    }
+    conn.partCount = 0;
+    conn.partNext = 0;
+    return true;
+}
+
+// Function to find the end of the first complete request in the buffer;
+// returns its length, or 0 if it has not all arrived yet
+static int requestLength(const Connection& conn) {
+    for(int i = 3; i < conn.inUsed; i++) {
+        if(conn.in[i] == '\n' && conn.in[i - 1] == '\r' && conn.in[i - 2] == '\n' && conn.in[i - 3] == '\r') return i + 1;
+    }
+    return 0;
+}
+
+static void serviceConnection(Worker& worker, Connection* conn, unsigned events) {
+    bool peerClosed = false;
+    if(events & EPOLLIN) {
+        while(conn->inUsed < REQUEST_BUFFER) {
+            ssize_t n = read(conn->fd, conn->in + conn->inUsed, REQUEST_BUFFER - conn->inUsed);
+            if(n > 0) {
+                conn->inUsed += (int)n;
+            } else if(n == 0) {
+                peerClosed = true;
+                break;
+            } else {
+                if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) peerClosed = true;
+                break;
+            }
+        }
+    } else if(events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(worker, conn);
+        return;
+    }
+    
+    // Answer requests in order, one response in flight at a time
+    if(!flushConnection(*conn)) {
+        closeConnection(worker, conn);
+        return;
+    }
+    while(conn->partCount == 0 && !conn->closeAfterWrite) {
+        int length = requestLength(*conn);
+        if(length == 0) {
+            if(conn->inUsed == REQUEST_BUFFER) {
+                conn->closeAfterWrite = true;
+                queueError(*conn, 431, "request too large");
+            } else {
+                break;
+            }
+        } else {
+            handleRequest(*conn, conn->in, length);
+            memmove(conn->in, conn->in + length, conn->inUsed - length);
+            conn->inUsed -= length;
+        }
+        if(!flushConnection(*conn)) {
+            closeConnection(worker, conn);
+            return;
+        }
+    }
+    
+    bool pending = conn->partCount > 0;
+    if(!pending && (conn->closeAfterWrite || peerClosed)) {
+        closeConnection(worker, conn);
+        return;
+    }
+    if(pending != conn->writing) {
+        struct epoll_event event;
+        event.events = pending ? EPOLLOUT : EPOLLIN;
+        event.data.ptr = conn;
+        epoll_ctl(worker.epoll, EPOLL_CTL_MOD, conn->fd, &event);
+        conn->writing = pending;
+    }
+}
+
+static void acceptConnections(Worker& worker) {
+    for(;;) {
+        int fd = accept4(listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;  // EAGAIN: none left, or another worker took it
+        
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Connection* conn = (Connection*)malloc(sizeof(Connection));
+        if(conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->inUsed = 0;
+        conn->closeAfterWrite = false;
+        conn->writing = false;
+        conn->partCount = 0;
+        conn->partNext = 0;
+        conn->prev = NULL;
+        conn->next = worker.connections;
+        if(worker.connections != NULL) worker.connections->prev = conn;
+        worker.connections = conn;
+        
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = conn;
+        epoll_ctl(worker.epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+static void runWorker(Worker* worker) {
+    struct epoll_event events[EPOLL_BATCH];
+    while(!stopRequested.load()) {
+        int count = epoll_wait(worker->epoll, events, EPOLL_BATCH, STOP_POLL_MS);
+        for(int i = 0; i < count; i++) {
+            if(events[i].data.ptr == NULL) acceptConnections(*worker);
+            else serviceConnection(*worker, (Connection*)events[i].data.ptr, events[i].events);
+        }
+    }
+    while(worker->connections != NULL) closeConnection(*worker, worker->connections);
+    close(worker->epoll);
+}
+
+bool startElementServer(int port, int threads) {
+    if(listenSocket >= 0) return false;
+    if(threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if(threads <= 0) threads = 1;
+    if(threads > MAX_SERVER_WORKERS) threads = MAX_SERVER_WORKERS;
+    buildResponseCache(elementColumns());
+    
+    listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listenSocket < 0) return false;
+    int one = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    if(bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, SOMAXCONN) != 0 ||
+       getsockname(listenSocket, (struct sockaddr*)&address, &addressLength) != 0) {
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    boundPort = ntohs(address.sin_port);
+    
+    // Every worker waits on the listening socket; EPOLLEXCLUSIVE wakes just
+    // one of them per connection
+#ifdef EPOLLEXCLUSIVE
+    const unsigned exclusive = EPOLLEXCLUSIVE;
+#else
+    const unsigned exclusive = 0;
+#endif
+    stopRequested.store(false);
+    workerCount = threads;
+    for(int i = 0; i < workerCount; i++) {
+        Worker& worker = workers[i];
+        worker.epoll = epoll_create1(EPOLL_CLOEXEC);
+        worker.connections = NULL;
+        struct epoll_event event;
+        event.events = EPOLLIN | exclusive;
+        event.data.ptr = NULL;
+        epoll_ctl(worker.epoll, EPOLL_CTL_ADD, listenSocket, &event);
+        worker.thread = std::thread(runWorker, &worker);
+    }
+    return true;
+}
+
+void stopElementServer() {
+    if(listenSocket < 0) return;
+    stopRequested.store(true);
+    for(int i = 0; i < workerCount; i++) workers[i].thread.join();
+    close(listenSocket);
+    listenSocket = -1;
+    workerCount = 0;
+}
+
+#else
+
+bool startElementServer(int, int) {
+    fprintf(stderr, "element server: not available on this platform (needs epoll)\n");
+    return false;
+}
+
+void stopElementServer() {
+}
+
+#endif
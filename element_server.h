@@ -0,0 +1,43 @@
+#ifndef ELEMENT_SERVER_H
+#define ELEMENT_SERVER_H
+
+// Loopback HTTP/1.1 service for tools that want the element data without
+// embedding their own copy. Listens on 127.0.0.1 only. Routes (GET):
+//
+//   /element/{symbol|number|name}   one element, e.g. /element/Fe
+//   /elements                       all of them
+//   /filter?q=block%3Dd             {"count":N,"elements":[...]}
+//   /mass?formula=Ca(OH)2           molar mass and composition
+//
+// Responses are JSON, the same objects the query mode writes
+// (query_stream.h). Connections are kept alive unless the client asks
+// otherwise, and pipelined requests are answered in order.
+//
+// A fixed pool of workers each runs its own epoll loop. The listening
+// socket is shared, and the worker that accepts a connection serves it
+// for its whole life, so a connection is only ever touched by one thread.
+// Every element's response, headers included, is serialized once at
+// startup: /element is a single write of bytes that already exist, and
+// /filter gathers the matching elements' bodies with writev. Nothing is
+// allocated per request. The data is the table current at startup.
+//
+// Linux only (epoll); elsewhere startElementServer reports failure.
+
+const int DEFAULT_SERVER_PORT = 8080;
+const int MAX_SERVER_WORKERS = 64;
+
+// Function to start serving on port (0 picks a free one) with the given
+// number of worker threads (0 means one per core). Returns false if the socket
+// could not be bound.
+bool startElementServer(int port, int threads);
+
+// The port actually bound, once started
+int elementServerPort();
+
+// Requests answered so far, all workers together
+long long elementServerRequests();
+
+// Function to stop the workers and close every connection
+void stopElementServer();
+
+#endif
@@ -0,0 +1,174 @@
+#include "element_snapshot.h"
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(SnapshotHeader) % alignof(ElementColumns) == 0,
+              "the payload must stay aligned for in-place use");
+static_assert(sizeof(ElementColumns) == 9376,
+              "ElementColumns changed: bump SNAPSHOT_VERSION and update this size");
+
+static const char SNAPSHOT_MAGIC[8] = { 'E', 'L', 'E', 'M', 'S', 'N', 'A', 'P' };
+
+// ---------------------------------------------------------------------------
+// CRC-32, slicing-by-8: eight bytes per step through eight tables built at
+// compile time. Checking the snapshot is the bulk of its startup cost, and
+// this is several times faster than the byte-at-a-time loop.
+// ---------------------------------------------------------------------------
+
+struct CrcTables {
+    uint32_t entry[8][256];
+};
+
+constexpr CrcTables buildCrcTables() {
+    CrcTables tables = {};
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for(int bit = 0; bit < 8; bit++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        tables.entry[0][i] = c;
+    }
+    for(int t = 1; t < 8; t++) {
+        for(int i = 0; i < 256; i++) {
+            uint32_t previous = tables.entry[t - 1][i];
+            tables.entry[t][i] = (previous >> 8) ^ tables.entry[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables CRC_TABLES = buildCrcTables();
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc) {
+    const unsigned char* p = (const unsigned char*)data;
+    const uint32_t (*t)[256] = CRC_TABLES.entry;
+    crc = ~crc;
+    for(; size >= 8; size -= 8, p += 8) {
+        // Byte-wise loads keep this independent of alignment and byte order
+        uint32_t low = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+        uint32_t high = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t)p[7] << 24;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for(; size > 0; size--, p++) crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// The fields buildElementColumns takes from each element, packed without
+// padding. Keep the two in step.
+const int TABLE_ROW_BYTES = 8 + 4 * 4 + 1;
+
+uint32_t elementTableChecksum() {
+    unsigned char rows[ELEMENT_COUNT * TABLE_ROW_BYTES];
+    unsigned char* row = rows;
+    for(int i = 0; i < ELEMENT_COUNT; i++, row += TABLE_ROW_BYTES) {
+        const Element& elem = ELEMENTS[i];
+        int32_t fields[4] = { elem.atomicNumber, elem.period, elem.group, elem.color };
+        memcpy(row, &elem.atomicWeight, 8);
+        memcpy(row + 8, fields, sizeof(fields));
+        row[8 + sizeof(fields)] = (unsigned char)elem.block[0];
+    }
+    return crc32(rows, sizeof(rows));
+}
+
+// ---------------------------------------------------------------------------
+// Writing and opening
+// ---------------------------------------------------------------------------
+
+bool writeSnapshot(const char* path, const ElementColumns& columns, uint32_t sourceChecksum,
+                   char* error, int errorSize) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.payloadSize = sizeof(ElementColumns);
+    header.elementCount = (uint32_t)columns.count;
+    header.payloadChecksum = crc32(&columns, sizeof(columns));
+    header.sourceChecksum = sourceChecksum;
+    header.tableChecksum = elementTableChecksum();
+    
+    char temporary[512];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* out = fopen(temporary, "wb");
+    if(out == NULL) {
+        snprintf(error, errorSize, "cannot create %s", temporary);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                   fwrite(&columns, sizeof(columns), 1, out) == 1;
+    if(fclose(out) != 0) written = false;
+    if(!written) {
+        remove(temporary);
+        snprintf(error, errorSize, "cannot write %s", temporary);
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(path);  // rename does not replace on Windows
+#endif
+    if(rename(temporary, path) != 0) {
+        remove(temporary);
+        snprintf(error, errorSize, "cannot replace %s", path);
+        return false;
+    }
+    return true;
+}
+
+bool openSnapshot(const char* path, MappedFile& file, const ElementColumns*& columns,
+                  char* error, int errorSize) {
+    columns = NULL;
+    if(!mapFile(path, file)) {
+        snprintf(error, errorSize, "not found");
+        return false;
+    }
+    
+    const char* problem = NULL;
+    const SnapshotHeader* header = (const SnapshotHeader*)file.data;
+    if(file.size < sizeof(SnapshotHeader) || memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        problem = "not a snapshot";
+    } else if(header->version != SNAPSHOT_VERSION) {
+        problem = "written by another version";
+    } else if(header->byteOrder != SNAPSHOT_BYTE_ORDER || header->headerSize != sizeof(SnapshotHeader) ||
+              header->payloadSize != sizeof(ElementColumns)) {
+        problem = "written for a different layout";
+    } else if(file.size != header->headerSize + header->payloadSize) {
+        problem = "wrong size";
+    } else if(header->elementCount != (uint32_t)ELEMENT_COUNT) {
+        problem = "built for a different element table";
+    } else if(header->tableChecksum != elementTableChecksum()) {
+        problem = "stale: the element table has changed";
+    } else if(crc32(file.data + header->headerSize, header->payloadSize) != header->payloadChecksum) {
+        problem = "checksum mismatch";
+    }
+    
+    if(problem != NULL) {
+        snprintf(error, errorSize, "%s", problem);
+        unmapFile(file);
+        return false;
+    }
+    columns = (const ElementColumns*)(file.data + header->headerSize);
+    return true;
+}
+
+const SnapshotHeader& snapshotHeader(const MappedFile& file) {
+    return *(const SnapshotHeader*)file.data;
+}
+
+bool snapshotMatchesSource(const MappedFile& file, const char* sourcePath) {
+    MappedFile source;
+    if(!mapFile(sourcePath, source)) return true;
+    bool same = crc32(source.data, source.size) == snapshotHeader(file).sourceChecksum;
+    unmapFile(source);
+    return same;
+}
+
+static const char* defaultSnapshotPath = DEFAULT_SNAPSHOT_FILE;
+
+void setSnapshotPath(const char* path) {
+    defaultSnapshotPath = path;
+}
+
+const char* snapshotPath() {
+    return defaultSnapshotPath;
+}
@@ -0,0 +1,74 @@
+#ifndef ELEMENT_SNAPSHOT_H
+#define ELEMENT_SNAPSHOT_H
+
+#include "element_columns.h"
+#include "mapped_file.h"
+#include <stdint.h>
+
+// Binary snapshot of the element columns for fast startup. The file is a
+// 64-byte header followed by the ElementColumns struct exactly as it sits
+// in memory. At startup it is memory-mapped and, once the header and
+// checksum check out, used in place: elementColumns() points straight into
+// the mapping. Nothing is parsed or copied.
+//
+// The layout is only valid for the build that wrote it. The header records
+// the version, payload size and byte order, and the loader rejects
+// anything else and falls back to the text data file. It does the same when
+// the data file's CRC-32 differs from the one recorded at build time, or
+// when the columns built from the compiled ELEMENTS table (weights, period,
+// group, block, colour) no longer match the ones the snapshot holds, so a
+// binary with a corrected table never serves the old values. Regenerate the snapshot with `elemental_headless snapshot-build` whenever
+// the data file or the table changes.
+
+const char* const DEFAULT_SNAPSHOT_FILE = "elements.snap";
+
+// Bump when ElementColumns changes; the static_assert in
+// element_snapshot.cpp will point here
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];            // "ELEMSNAP"
+    uint32_t version;
+    uint32_t byteOrder;       // SNAPSHOT_BYTE_ORDER as written by the generator
+    uint32_t headerSize;
+    uint32_t payloadSize;     // sizeof(ElementColumns)
+    uint32_t elementCount;
+    uint32_t payloadChecksum; // CRC-32 of the payload
+    uint32_t sourceChecksum;  // CRC-32 of the data file it was built from
+    uint32_t tableChecksum;   // elementTableChecksum() of the build that wrote it
+    char reserved[24];
+};
+
+// Function to compute a CRC-32 (the zlib polynomial)
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// Function to checksum the values the columns take from the compiled
+// ELEMENTS table (weight, number, period, group, colour, block). About 3 KB,
+// so it is cheap enough to run on every open.
+uint32_t elementTableChecksum();
+
+// Function to write columns as a snapshot. The file is written beside path
+// and renamed into place, so a reader never maps a half-written file.
+bool writeSnapshot(const char* path, const ElementColumns& columns, uint32_t sourceChecksum,
+                   char* error, int errorSize);
+
+// Function to map and check a snapshot, including that it was built from
+// this build's element table. On success columns points into file, which
+// must stay mapped while they are in use.
+bool openSnapshot(const char* path, MappedFile& file, const ElementColumns*& columns,
+                  char* error, int errorSize);
+
+// Function to read a snapshot's header after openSnapshot succeeded
+const SnapshotHeader& snapshotHeader(const MappedFile& file);
+
+// Function to check an open snapshot was built from the data file at
+// sourcePath. With no data file to compare against it passes: the snapshot
+// is all there is.
+bool snapshotMatchesSource(const MappedFile& file, const char* sourcePath);
+
+// The file elementColumns() tries before the text data; set before first use
+void setSnapshotPath(const char* path);
+const char* snapshotPath();
+
+#endif
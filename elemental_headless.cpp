@@ -0,0 +1,1046 @@
+#include <iostream>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include "elements.h"
+#include "element_query.h"
+#include "table_view.h"
+#include "render_null.h"
+#include "element_columns.h"
+#include "element_filter.h"
+#include "element_search.h"
+#include "element_compare.h"
+#include "element_data.h"
+#include "mapped_file.h"
+#include "element_snapshot.h"
+#include "element_reload.h"
+#include "chemical_formula.h"
+#include "query_stream.h"
+#include "element_server.h"
+#include "server_load_test.h"
+#include "nuclide_data.h"
+#include "nuclide_chart.h"
+#include "timing.h"
+using namespace std;
+
+// Headless entry point: runs the element core and the table view against
+// NullBackend, so everything except the WinBGIm window can be built, checked
+// and profiled on Linux.
+//
+//   elemental_headless validate
+//   elemental_headless bench-load [iterations]
+//   elemental_headless snapshot-build [path]
+//   elemental_headless snapshot-check [path]
+//   elemental_headless bench-startup [iterations]
+//   elemental_headless bench [iterations]
+//   elemental_headless bench-columns [iterations]
+//   elemental_headless bench-search [iterations]
+//   elemental_headless bench-animation [seconds] [fps]
+//   elemental_headless filter "<expression>"
+//   elemental_headless compare <symbol> <symbol> ...
+//   elemental_headless watch [seconds]
+//   elemental_headless molar-mass <formula> ...
+//   elemental_headless formula-batch <input> [output] [threads]
+//   elemental_headless bench-formula [formulas]
+//   elemental_headless query [file] [--csv] [--stats]
+//   elemental_headless bench-query [queries]
+//   elemental_headless nuclides <symbol>
+//   elemental_headless bench-chart [frames]
+//   elemental_headless bench-zoom [rounds] [width] [height]
+//   elemental_headless serve [port] [threads] [seconds]
+//   elemental_headless bench-server [connections] [seconds] [threads]
+
+void printCounters(const char* label, const DrawCounters& c, int frames) {
+    cout << "  " << label << " per frame: "
+         << (double)c.texts / frames << " texts, "
+         << (double)c.textStyleChanges / frames << " font switches, "
+         << (double)c.rectangles / frames << " rectangles, "
+         << (double)c.circles / frames << " circles, "
+         << (double)c.imagePuts / frames << " blits ("
+         << (double)c.pixelsCopied / frames << " px)" << endl;
+}
+
+// Function to time hit-testing over every pixel of the table area
+void benchHitTesting(int iterations) {
+    long long start = timerNow();
+    long long hits = 0;
+    long long probes = 0;
+    for(int n = 0; n < iterations; n++) {
+        for(int y = 0; y < baseY + GRID_ROWS * boxSize + 10; y++) {
+            for(int x = 0; x < baseX + GRID_COLS * boxSize + 10; x++) {
+                if(elementAt(ELEMENTS, x, y) >= 0) hits++;
+                probes++;
+            }
+        }
+    }
+    double ms = timerMs(timerNow() - start);
+    cout << "hit-testing: " << probes << " probes in " << ms << " ms ("
+         << ms * 1000000.0 / probes << " ns/probe, " << hits << " hits)" << endl;
+}
+
+// Function to time full repaints, hover sweeps and popup open/close cycles
+void benchRendering(int iterations) {
+    NullBackend backend(WINDOW_WIDTH, WINDOW_HEIGHT);
+    logClickLatency = false;
+    initTableView(&backend);
+    
+    backend.resetCounters();
+    long long start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        invalidateRect(screenRect());
+        renderFrame(ELEMENTS, ELEMENT_COUNT);
+    }
+    double ms = timerMs(timerNow() - start);
+    cout << "full repaint: " << ms / iterations << " ms/frame" << endl;
+    printCounters("full repaint", backend.counters(), iterations);
+    
+    backend.resetCounters();
+    int frames = 0;
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        for(int i = 0; i < ELEMENT_COUNT; i++) {
+            backend.postEvent(EVENT_MOUSEMOVE, ELEMENTS[i].x + boxSize / 2, ELEMENTS[i].y + boxSize / 2, 0);
+            processNextEvent(0);
+            frames++;
+        }
+    }
+    ms = timerMs(timerNow() - start);
+    cout << "hover sweep: " << ms / frames << " ms/frame" << endl;
+    printCounters("hover", backend.counters(), frames);
+    
+    // The first pass over the table draws every Bohr diagram; later passes
+    // blit them from the cache. Closing is counted separately: it should be
+    // the save-under blit plus the clicked cell.
+    for(int pass = 0; pass < 2; pass++) {
+        int cycles = pass == 0 ? ELEMENT_COUNT : iterations;
+        DrawCounters closeCounters = {};
+        backend.resetCounters();
+        start = timerNow();
+        for(int n = 0; n < cycles; n++) {
+            const Element& elem = ELEMENTS[n % ELEMENT_COUNT];
+            backend.postEvent(EVENT_CLICK, elem.x + boxSize / 2, elem.y + boxSize / 2, 0);
+            processNextEvent(0);
+            
+            DrawCounters before = backend.counters();
+            backend.postEvent(EVENT_KEY, 0, 0, KEY_ESCAPE);
+            processNextEvent(0);
+            closeCounters.texts += backend.counters().texts - before.texts;
+            closeCounters.textStyleChanges += backend.counters().textStyleChanges - before.textStyleChanges;
+            closeCounters.rectangles += backend.counters().rectangles - before.rectangles;
+            closeCounters.circles += backend.counters().circles - before.circles;
+            closeCounters.imagePuts += backend.counters().imagePuts - before.imagePuts;
+            closeCounters.pixelsCopied += backend.counters().pixelsCopied - before.pixelsCopied;
+        }
+        ms = timerMs(timerNow() - start);
+        const char* label = pass == 0 ? "popup first open" : "popup reopen";
+        cout << label << " + close: " << ms / cycles << " ms/cycle" << endl;
+        printCounters(label, backend.counters(), cycles);
+        printCounters("popup close", closeCounters, cycles);
+    }
+    
+    // Shift+click builds up a comparison one element at a time; each step
+    // should repaint the new cell, the new row and the header, not the panel
+    backend.resetCounters();
+    for(int i = 0; i < MAX_COMPARE; i++) {
+        const Element& elem = ELEMENTS[i * 11];
+        backend.postEvent(EVENT_CLICK, elem.x + boxSize / 2, elem.y + boxSize / 2, 0, MOD_SHIFT);
+        processNextEvent(0);
+    }
+    printCounters("compare add", backend.counters(), MAX_COMPARE);
+    backend.postEvent(EVENT_KEY, 0, 0, 'x');
+    processNextEvent(0);
+    
+    // Each heatmap switch re-tints every cell from its stencil; the only text
+    // drawn should be the legend's. Whole cycles, so it ends on categories.
+    int switches = (iterations / (PROP_COUNT + 1) + 1) * (PROP_COUNT + 1);
+    DrawCounters heatCounters = {};
+    double heatMs = 0;
+    for(int n = 0; n < switches; n++) {
+        backend.resetCounters();
+        start = timerNow();
+        backend.postEvent(EVENT_KEY, 0, 0, 'h');
+        processNextEvent(0);
+        if((n + 1) % (PROP_COUNT + 1) == 0) continue;  // back to categories
+        heatMs += timerMs(timerNow() - start);
+        heatCounters.texts += backend.counters().texts;
+        heatCounters.textStyleChanges += backend.counters().textStyleChanges;
+        heatCounters.rectangles += backend.counters().rectangles;
+        heatCounters.bars += backend.counters().bars;
+        heatCounters.imagePuts += backend.counters().imagePuts;
+        heatCounters.pixelsCopied += backend.counters().pixelsCopied;
+    }
+    int heatFrames = switches / (PROP_COUNT + 1) * PROP_COUNT;
+    cout << "heatmap switch: " << heatMs / heatFrames << " ms/frame" << endl;
+    printCounters("heatmap switch", heatCounters, heatFrames);
+    
+    const LatencyStats& latency = clickLatencyStats();
+    if(latency.samples > 0) {
+        cout << "click-to-paint: avg " << latency.totalMs / latency.samples
+             << " ms, worst " << latency.worstMs << " ms" << endl;
+    }
+}
+
+// Array-of-structs reference versions of the column queries
+ElementMask aosMaskGreater(double Element::*field, double threshold) {
+    ElementMask mask = emptyMask();
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(ELEMENTS[i].*field > threshold) maskSet(mask, i);
+    }
+    return mask;
+}
+
+ElementMask aosMaskRange(double Element::*field, double low, double high) {
+    ElementMask mask = emptyMask();
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        double x = ELEMENTS[i].*field;
+        if(x >= low && x <= high) maskSet(mask, i);
+    }
+    return mask;
+}
+
+ColumnStats aosStats(double Element::*field) {
+    ColumnStats stats = { ELEMENTS[0].*field, ELEMENTS[0].*field, 0, 0 };
+    double sum = 0;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        double x = ELEMENTS[i].*field;
+        if(x < stats.min) stats.min = x;
+        if(x > stats.max) stats.max = x;
+        sum += x;
+    }
+    stats.count = ELEMENT_COUNT;
+    stats.mean = sum / ELEMENT_COUNT;
+    return stats;
+}
+
+// Function to compare the struct-of-arrays kernels with plain loops over the
+// ELEMENTS array for the analytics queries: threshold, range and min/max/mean
+void benchColumns(int iterations) {
+    const ElementColumns& columns = elementColumns();
+    volatile long long sink = 0;
+    
+    ColumnStats aos = aosStats(&Element::atomicWeight);
+    ColumnStats soa = columnStats(columns.atomicWeight, columns.count, NULL);
+    if(!maskEqual(aosMaskRange(&Element::atomicWeight, 50, 150), maskRange(columns.atomicWeight, 50, 150)) ||
+       !maskEqual(aosMaskGreater(&Element::atomicWeight, 100), maskGreater(columns.atomicWeight, 100)) ||
+       aos.min != soa.min || aos.max != soa.max || fabs(aos.mean - soa.mean) > 1e-9 || aos.count != soa.count) {
+        cout << "column kernels disagree with the AoS reference" << endl;
+    }
+    
+    long long start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        sink += maskCount(aosMaskGreater(&Element::atomicWeight, 100 + (n & 7)));
+        sink += maskCount(aosMaskRange(&Element::atomicWeight, 50, 150 + (n & 7)));
+        sink += (long long)aosStats(&Element::atomicWeight).mean;
+    }
+    double aosMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        sink += maskCount(maskGreater(columns.atomicWeight, 100 + (n & 7)));
+        sink += maskCount(maskRange(columns.atomicWeight, 50, 150 + (n & 7)));
+        sink += (long long)columnStats(columns.atomicWeight, columns.count, NULL).mean;
+    }
+    double soaMs = timerMs(timerNow() - start);
+    
+    cout << "threshold + range + stats over " << ELEMENT_COUNT << " elements:" << endl;
+    cout << "  array of structs: " << aosMs * 1000000.0 / iterations << " ns/query set" << endl;
+    cout << "  columns (SIMD):   " << soaMs * 1000000.0 / iterations << " ns/query set" << endl;
+}
+
+bool startsWithNoCase(const char* text, const char* prefix) {
+    for(; *prefix; text++, prefix++) {
+        if(tolower((unsigned char)*text) != tolower((unsigned char)*prefix)) return false;
+    }
+    return true;
+}
+
+// Function to run the orbit animation with steady background input and
+// report frame pacing, frame-time and input-latency percentiles
+void benchAnimation(double seconds, int fps) {
+    NullBackend backend(WINDOW_WIDTH, WINDOW_HEIGHT);
+    logClickLatency = false;
+    initTableView(&backend);
+    setTargetFps(fps);
+    
+    const Element& elem = ELEMENTS[ELEMENT_COUNT - 1];  // seven shells, most electrons
+    backend.postEvent(EVENT_CLICK, elem.x + boxSize / 2, elem.y + boxSize / 2, 0);
+    processNextEvent(0);
+    backend.postEvent(EVENT_KEY, 0, 0, 'a');
+    processNextEvent(0);
+    backend.resetCounters();
+    
+    // A mouse move every 7 ms, off the frame grid, stands in for the user
+    const long long inputInterval = 7000000;
+    long long start = timerNow();
+    long long end = start + (long long)(seconds * 1e9);
+    long long nextInput = start;
+    while(timerNow() < end) {
+        long long now = timerNow();
+        if(now >= nextInput) {
+            backend.postEvent(EVENT_MOUSEMOVE, 100, 100, 0);
+            nextInput += inputInterval;
+        }
+        processNextEvent((int)((nextInput - now) / 1000000));
+    }
+    double ms = timerMs(timerNow() - start);
+    
+    PercentileStats frames = animationFrameTimes();
+    PercentileStats input = animationInputLatency();
+    cout << "orbit animation, target " << fps << " fps, " << seconds << " s:" << endl;
+    cout << "  " << frames.samples << " frames (" << frames.samples * 1000.0 / ms << " fps)" << endl;
+    cout << "  frame time p50 " << frames.p50Ms << " ms, p99 " << frames.p99Ms << " ms" << endl;
+    cout << "  input latency p50 " << input.p50Ms << " ms, p99 " << input.p99Ms << " ms ("
+         << input.samples << " events)" << endl;
+    if(frames.samples > 0) printCounters("animation", backend.counters(), frames.samples);
+}
+
+// Reference search: compare the prefix against every name and symbol
+ElementMask scanSearch(const char* prefix) {
+    ElementMask mask = emptyMask();
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(startsWithNoCase(ELEMENTS[i].name, prefix) ||
+           startsWithNoCase(ELEMENTS[i].symbol, prefix)) maskSet(mask, i);
+    }
+    return mask;
+}
+
+int scanSymbol(const char* symbol) {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(startsWithNoCase(ELEMENTS[i].symbol, symbol) && strlen(ELEMENTS[i].symbol) == strlen(symbol)) return i;
+    }
+    return -1;
+}
+
+// Function to time search-as-you-type: every element name is typed one
+// character at a time and each keystroke runs a full search
+void benchSearch(int iterations) {
+    // Every prefix of every name, as the user would type it
+    static char prefixes[ELEMENT_COUNT * 20][20];
+    int prefixCount = 0;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        int length = strlen(ELEMENTS[i].name);
+        for(int n = 1; n <= length; n++) {
+            memcpy(prefixes[prefixCount], ELEMENTS[i].name, n);
+            prefixes[prefixCount++][n] = '\0';
+        }
+    }
+    
+    for(int p = 0; p < prefixCount; p++) {
+        if(!maskEqual(searchElements(prefixes[p]), scanSearch(prefixes[p]))) {
+            cout << "trie disagrees with the linear scan for '" << prefixes[p] << "'" << endl;
+        }
+    }
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(findSymbol(ELEMENTS[i].symbol) != i) cout << "perfect hash misses " << ELEMENTS[i].symbol << endl;
+    }
+    
+    volatile long long sink = 0;
+    long long start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        for(int p = 0; p < prefixCount; p++) sink += maskCount(scanSearch(prefixes[p]));
+    }
+    double scanMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        for(int p = 0; p < prefixCount; p++) sink += maskCount(searchElements(prefixes[p]));
+    }
+    double trieMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        for(int i = 0; i < ELEMENT_COUNT; i++) sink += scanSymbol(ELEMENTS[i].symbol);
+    }
+    double scanSymbolMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        for(int i = 0; i < ELEMENT_COUNT; i++) sink += findSymbol(ELEMENTS[i].symbol);
+    }
+    double hashMs = timerMs(timerNow() - start);
+    
+    double keystrokes = (double)iterations * prefixCount;
+    double lookups = (double)iterations * ELEMENT_COUNT;
+    cout << "search as you type (" << prefixCount << " keystrokes per pass):" << endl;
+    cout << "  linear scan: " << scanMs * 1000000.0 / keystrokes << " ns/keystroke" << endl;
+    cout << "  prefix trie: " << trieMs * 1000000.0 / keystrokes << " ns/keystroke" << endl;
+    cout << "exact symbol lookup:" << endl;
+    cout << "  linear scan:  " << scanSymbolMs * 1000000.0 / lookups << " ns/lookup" << endl;
+    cout << "  perfect hash: " << hashMs * 1000000.0 / lookups << " ns/lookup" << endl;
+}
+
+// Function to print the elements matching a filter expression
+int runFilter(const char* text) {
+    ElementFilter filter;
+    if(!parseFilter(text, filter)) {
+        cerr << "filter: " << filter.error << endl;
+        return 1;
+    }
+    
+    ElementMask mask = evaluateFilter(filter, elementColumns());
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(maskTest(mask, i)) cout << ELEMENTS[i].symbol << " ";
+    }
+    cout << endl << maskCount(mask) << " matches" << endl;
+    return 0;
+}
+
+// Function to time the element data load: the whole map + parse as done at
+// startup, and the parse alone over an already mapped file
+void benchLoad(int iterations) {
+    const char* path = elementDataPath();
+    ElementColumns columns;
+    DataLoadReport report;
+    
+    double loadMs = 0;
+    for(int n = 0; n < iterations; n++) {
+        buildElementColumns(columns, ELEMENTS, ELEMENT_COUNT);
+        if(!loadElementData(path, columns, report)) {
+            cout << "bench-load: cannot open " << path << endl;
+            return;
+        }
+        loadMs += report.loadMs;
+    }
+    
+    MappedFile file;
+    mapFile(path, file);
+    long long start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        report = DataLoadReport();
+        parseElementData(file.data, file.size, columns, report);
+    }
+    double parseMs = timerMs(timerNow() - start);
+    
+    cout << path << ": " << file.size << " bytes, " << report.rows << " rows, " << report.values << " values" << endl;
+    cout << "  map + parse: " << loadMs / iterations << " ms" << endl;
+    cout << "  parse only:  " << parseMs / iterations << " ms ("
+         << file.size * (double)iterations / (parseMs / 1000.0) / 1e6 << " MB/s)" << endl;
+    unmapFile(file);
+}
+
+// Function to build the columns the slow way, from the compiled table and
+// the text data file, and checksum the data file. The snapshot is made
+// from and checked against these.
+bool loadSourceColumns(ElementColumns& columns, uint32_t& sourceChecksum) {
+    DataLoadReport report;
+    buildElementColumns(columns, ELEMENTS, ELEMENT_COUNT);
+    if(!loadElementData(elementDataPath(), columns, report) || report.errors > 0) {
+        printDataLoadReport(report, elementDataPath());
+        return false;
+    }
+    MappedFile source;
+    mapFile(elementDataPath(), source);
+    sourceChecksum = crc32(source.data, source.size);
+    unmapFile(source);
+    return true;
+}
+
+// Function to regenerate the binary snapshot from the data file
+int buildSnapshot(const char* path) {
+    static ElementColumns columns;
+    uint32_t sourceChecksum;
+    if(!loadSourceColumns(columns, sourceChecksum)) return 1;
+    
+    char error[80];
+    if(!writeSnapshot(path, columns, sourceChecksum, error, sizeof(error))) {
+        cerr << "snapshot-build: " << error << endl;
+        return 1;
+    }
+    cout << "wrote " << path << ": " << sizeof(SnapshotHeader) + sizeof(ElementColumns) << " bytes, "
+         << columns.count << " elements, from " << elementDataPath() << endl;
+    return 0;
+}
+
+// Function to check a snapshot is readable and matches the current data
+int checkSnapshot(const char* path) {
+    MappedFile file;
+    const ElementColumns* mapped;
+    char error[48];
+    if(!openSnapshot(path, file, mapped, error, sizeof(error))) {
+        cout << path << ": " << error << endl;
+        return 1;
+    }
+    
+    static ElementColumns columns;
+    uint32_t sourceChecksum;
+    int status = 1;
+    if(loadSourceColumns(columns, sourceChecksum)) {
+        bool sameSource = snapshotHeader(file).sourceChecksum == sourceChecksum;
+        bool sameColumns = memcmp(mapped, &columns, sizeof(columns)) == 0;
+        if(sameSource && sameColumns) {
+            cout << path << ": version " << snapshotHeader(file).version << ", up to date" << endl;
+            status = 0;
+        } else {
+            cout << path << ": stale (" << (sameSource ? "element table" : elementDataPath())
+                 << " changed); run snapshot-build" << endl;
+        }
+    }
+    unmapFile(file);
+    return status;
+}
+
+// Function to compare the two startup paths: compiled table plus text
+// data file, and the mapped snapshot with the same checks as startup (the
+// payload, element table and data file checksums). Both run with the files
+// in the OS cache, so this is the parsing and checking cost, not disk
+// latency.
+void benchStartup(int iterations) {
+    static ElementColumns columns;
+    DataLoadReport report;
+    long long start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        buildElementColumns(columns, ELEMENTS, ELEMENT_COUNT);
+        loadElementData(elementDataPath(), columns, report);
+    }
+    double textMs = timerMs(timerNow() - start) / iterations;
+    
+    MappedFile file;
+    const ElementColumns* mapped;
+    char error[48];
+    double snapshotMs = 0;
+    start = timerNow();
+    for(int n = 0; n < iterations; n++) {
+        if(!openSnapshot(snapshotPath(), file, mapped, error, sizeof(error))) {
+            cout << "bench-startup: snapshot " << snapshotPath() << ": " << error << " (run snapshot-build)" << endl;
+            return;
+        }
+        bool stale = !snapshotMatchesSource(file, elementDataPath());
+        unmapFile(file);
+        if(stale) {
+            cout << "bench-startup: snapshot " << snapshotPath() << " is stale (run snapshot-build)" << endl;
+            return;
+        }
+    }
+    snapshotMs = timerMs(timerNow() - start) / iterations;
+    
+    cout << "startup, element columns ready:" << endl;
+    cout << "  table + " << elementDataPath() << ": " << textMs * 1000.0 << " us" << endl;
+    cout << "  mapped " << snapshotPath() << ":    " << snapshotMs * 1000.0 << " us ("
+         << textMs / snapshotMs << "x faster)" << endl;
+}
+
+// Function to print a comparison of the elements named by symbol
+int runCompare(int count, char* symbols[]) {
+    int elements[MAX_COMPARE];
+    if(count > MAX_COMPARE) count = MAX_COMPARE;
+    for(int i = 0; i < count; i++) {
+        elements[i] = findSymbol(symbols[i]);
+        if(elements[i] < 0) {
+            cerr << "compare: unknown symbol " << symbols[i] << endl;
+            return 1;
+        }
+    }
+    
+    Comparison comparison;
+    compareElements(elementColumns(), elements, count, comparison);
+    char line[96];
+    for(int p = 0; p < PROP_COUNT; p++) {
+        cout << propertyName(p);
+        if(propertyUnit(p)[0] != '\0') cout << " (" << propertyUnit(p) << ")";
+        cout << ":" << endl;
+        for(int i = 0; i < count; i++) {
+            if(comparison.rank[p][i] == 0) {
+                snprintf(line, sizeof(line), "  %-3s %10s", ELEMENTS[elements[i]].symbol, "-");
+            } else {
+                snprintf(line, sizeof(line), "  %-3s %10.3f %+10.3f  #%d", ELEMENTS[elements[i]].symbol,
+                         comparison.value[p][i], comparison.delta[p][i], comparison.rank[p][i]);
+            }
+            cout << line << endl;
+        }
+    }
+    return 0;
+}
+
+// Function to print the molar mass and composition of each formula
+int runMolarMass(int count, char* formulas[]) {
+    const ElementColumns& columns = elementColumns();
+    int status = 0;
+    for(int f = 0; f < count; f++) {
+        FormulaResult result;
+        if(!parseFormula(formulas[f], columns, result)) {
+            cerr << formulas[f] << ": " << result.error << " at column " << result.errorPosition + 1 << endl;
+            status = 1;
+            continue;
+        }
+        
+        char line[96];
+        snprintf(line, sizeof(line), "%s: %.4f g/mol", formulas[f], result.molarMass);
+        cout << line;
+        if(result.charge != 0) cout << ", charge " << (result.charge > 0 ? "+" : "") << result.charge;
+        cout << endl;
+        for(int i = 0; i < result.elementCount; i++) {
+            snprintf(line, sizeof(line), "  %-3s %8lld  %7.3f%%", ELEMENTS[result.element[i]].symbol,
+                     result.atoms[i], result.massPercent[i]);
+            cout << line << endl;
+        }
+    }
+    return status;
+}
+
+// Function to print a batch report
+void printBatchReport(const FormulaBatchReport& report) {
+    cerr << report.formulas << " formulas, " << report.errors << " errors, " << report.threads << " thread(s), "
+         << report.ms << " ms (" << report.formulas / (report.ms / 1000.0) / 1e6 << " M formulas/s)" << endl;
+    if(report.errors > 0) cerr << "  first error, line " << report.firstErrorLine << ": " << report.firstError << endl;
+}
+
+// Function to compute molar masses for every line of a file, writing
+// formula,mass lines to output (or nowhere)
+int runFormulaBatchCommand(const char* input, const char* output, int threads) {
+    FILE* out = NULL;
+    if(output != NULL) {
+        out = strcmp(output, "-") == 0 ? stdout : fopen(output, "w");
+        if(out == NULL) {
+            cerr << "formula-batch: cannot create " << output << endl;
+            return 1;
+        }
+    }
+    
+    FormulaBatchReport report;
+    bool opened = runFormulaBatchFile(input, elementColumns(), threads, out, report);
+    if(out != NULL && out != stdout) fclose(out);
+    if(!opened) {
+        cerr << "formula-batch: cannot open " << input << endl;
+        return 1;
+    }
+    printBatchReport(report);
+    return report.errors == 0 ? 0 : 1;
+}
+
+// Function to time the batch mode over a synthetic catalog, on one thread
+// and then on every core
+void benchFormula(int count) {
+    const char* samples[] = {
+        "H2O", "NaCl", "C6H12O6", "Ca(OH)2", "CuSO4·5H2O", "K4[Fe(CN)6]", "Al2(SO4)3", "C8H10N4O2",
+        "Mg3(PO4)2", "NH4+", "SO4^2-", "Na2CO3·10H2O", "(NH4)2Fe(SO4)2·6H2O", "C20H25N3O", "Fe2O3", "KMnO4"
+    };
+    const int sampleCount = sizeof(samples) / sizeof(samples[0]);
+    
+    size_t size = 0;
+    for(int i = 0; i < count; i++) size += strlen(samples[i % sampleCount]) + 1;
+    char* catalog = (char*)malloc(size);
+    if(catalog == NULL) {
+        cerr << "bench-formula: out of memory" << endl;
+        return;
+    }
+    char* p = catalog;
+    for(int i = 0; i < count; i++) {
+        size_t length = strlen(samples[i % sampleCount]);
+        memcpy(p, samples[i % sampleCount], length);
+        p += length;
+        *p++ = '\n';
+    }
+    
+    const ElementColumns& columns = elementColumns();
+    FormulaBatchReport single, parallel;
+    runFormulaBatch(catalog, size, columns, 1, NULL, single);
+    runFormulaBatch(catalog, size, columns, 0, NULL, parallel);
+    free(catalog);
+    
+    cout << "molar mass batch, " << count << " formulas (" << size / 1e6 << " MB), parse + format:" << endl;
+    cout << "  1 thread:   " << single.formulas / (single.ms / 1000.0) / 1e6 << " M formulas/s ("
+         << single.ms * 1e6 / single.formulas << " ns each)" << endl;
+    cout << "  " << parallel.threads << " thread(s): " << parallel.formulas / (parallel.ms / 1000.0) / 1e6
+         << " M formulas/s (" << single.ms / parallel.ms << "x)" << endl;
+    if(single.errors + parallel.errors > 0) cout << "  unexpected errors: " << single.firstError << endl;
+}
+
+// Function to answer queries from a file (or stdin) on stdout
+int runQuery(int argc, char* argv[]) {
+    const char* path = NULL;
+    int format = FORMAT_JSON_LINES;
+    bool stats = false;
+    for(int i = 0; i < argc; i++) {
+        if(strcmp(argv[i], "--csv") == 0) format = FORMAT_CSV;
+        else if(strcmp(argv[i], "--stats") == 0) stats = true;
+        else if(strcmp(argv[i], "-") != 0) path = argv[i];
+    }
+    
+    FILE* in = path != NULL ? fopen(path, "rb") : stdin;
+    if(in == NULL) {
+        cerr << "query: cannot open " << path << endl;
+        return 1;
+    }
+    QueryStreamReport report;
+    runQueryStream(in, stdout, format, report);
+    if(in != stdin) fclose(in);
+    if(stats) printQueryStreamReport(report);
+    return 0;
+}
+
+// Function to time the query stream end to end, file in and file out,
+// over a mix of lookups, filters and formulas
+void benchQuery(int count) {
+    const char* samples[] = {
+        "Fe", "26", "gold", "get Og", "mass Ca(OH)2·2H2O", "mass K4[Fe(CN)6]", "filter block=d & weight>100",
+        "U", "mass C6H12O6", "H", "filter category=noble", "Xx"
+    };
+    const int sampleCount = sizeof(samples) / sizeof(samples[0]);
+    
+    FILE* in = tmpfile();
+    FILE* out = tmpfile();
+    if(in == NULL || out == NULL) {
+        cerr << "bench-query: cannot create temporary files" << endl;
+        return;
+    }
+    for(int i = 0; i < count; i++) {
+        fputs(samples[i % sampleCount], in);
+        fputc('\n', in);
+    }
+    
+    const char* formatNames[] = { "JSON Lines", "CSV" };
+    for(int format = FORMAT_JSON_LINES; format <= FORMAT_CSV; format++) {
+        rewind(in);
+        rewind(out);
+        QueryStreamReport report;
+        runQueryStream(in, out, format, report);
+        double seconds = report.ms / 1000.0;
+        cout << formatNames[format] << ": " << report.queries << " queries -> " << report.records << " records, "
+             << report.queries / seconds / 1e6 << " M queries/s, " << report.bytesIn / seconds / 1e6 << " MB/s in, "
+             << report.bytesOut / seconds / 1e6 << " MB/s out" << endl;
+    }
+    fclose(in);
+    fclose(out);
+}
+
+// Function to run the view with the data watcher for a while, heatmap on,
+// printing the repaint each reload caused. Edit the data file meanwhile.
+void runWatch(double seconds) {
+    NullBackend backend(WINDOW_WIDTH, WINDOW_HEIGHT);
+    logClickLatency = false;
+    initTableView(&backend);
+    backend.postEvent(EVENT_KEY, 0, 0, 'h');
+    processNextEvent(0);
+    
+    if(!startDataWatcher(elementDataPath(), wakeTableView)) {
+        cerr << "watch: cannot watch " << elementDataPath() << endl;
+        return;
+    }
+    cout << "watching " << elementDataPath() << " for " << seconds << " s" << endl;
+    
+    long long end = timerNow() + (long long)(seconds * 1e9);
+    while(timerNow() < end) {
+        backend.resetCounters();
+        if(processNextEvent(100)) printCounters("reload", backend.counters(), 1);
+    }
+    stopDataWatcher();
+}
+
+// Function to serve the element data over HTTP, for the given time or
+// until killed
+int runServe(int port, int threads, double seconds) {
+    if(!startElementServer(port, threads)) return 1;
+    cout << "serving http://127.0.0.1:" << elementServerPort() << "/element/Fe" << endl;
+    
+    long long end = timerNow() + (long long)(seconds * 1e9);
+    while(seconds <= 0 || timerNow() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    cout << elementServerRequests() << " requests" << endl;
+    stopElementServer();
+    return 0;
+}
+
+// Function to load the server from this process over loopback and print
+// throughput and the latency percentiles
+int benchServer(int connections, double seconds, int threads) {
+    if(!startElementServer(0, threads)) return 1;
+    LoadTestReport report;
+    bool ran = runLoadTest(elementServerPort(), connections, seconds, report);
+    long long served = elementServerRequests();
+    stopElementServer();
+    if(!ran) return 1;
+    
+    cout << report.connections << " connections on " << report.threads << " client threads, "
+         << report.seconds << " s" << endl;
+    cout << "  " << report.requests / report.seconds << " requests/s, " << report.errors << " errors, "
+         << served << " answered by the server" << endl;
+    cout << "  latency p50 " << report.p50Us << " us, p99 " << report.p99Us << " us, p99.9 "
+         << report.p999Us << " us, max " << report.maxUs << " us" << endl;
+    return report.errors == 0 ? 0 : 1;
+}
+
+// Function to list an element's nuclides
+int runNuclides(const char* symbol) {
+    Span span = { symbol, symbol + strlen(symbol) };
+    int index = symbolIndex(span);
+    if(index < 0) {
+        cerr << "nuclides: unknown symbol " << symbol << endl;
+        return 1;
+    }
+    const NuclideTable& table = nuclideTable();
+    int z = index + 1;
+    for(int i = table.first[z]; i < table.first[z + 1]; i++) {
+        const Nuclide& nuclide = table.nuclide[i];
+        char halfLife[24];
+        formatHalfLife(halfLife, sizeof(halfLife), nuclide.halfLife);
+        printf("%s-%-4d N %-4d %-12s %-9s", symbol, z + nuclide.n, nuclide.n, halfLife, decayModeName(nuclide.decay));
+        if(nuclide.abundance > 0) printf(" %.6g%%", nuclide.abundance);
+        printf("\n");
+    }
+    return 0;
+}
+
+// Function to fill a table with a band of made-up nuclides along the
+// valley of stability, about as many as are known, for the chart benchmark
+void buildSyntheticNuclides(NuclideTable& table) {
+    table.count = 0;
+    for(int z = 1; z <= ELEMENT_COUNT; z++) {
+        int center = z + z * z / 160;
+        int width = 6 + z / 8;
+        for(int n = max(0, center - width); n <= center + width && table.count < MAX_NUCLIDES; n++) {
+            int decay = z > 83 ? DECAY_ALPHA : DECAY_STABLE;
+            if(n < center - 1 && z <= 83) decay = DECAY_BETA_PLUS;
+            if(n > center + 1) decay = DECAY_BETA_MINUS;
+            float halfLife = decay == DECAY_STABLE ? INFINITY : (float)pow(10.0, 6 - 1.5 * abs(n - center));
+            Nuclide nuclide = { (unsigned char)z, (unsigned char)n, (unsigned char)decay, 0, halfLife, 0 };
+            table.nuclide[table.count++] = nuclide;
+        }
+    }
+    DataLoadReport report = DataLoadReport();
+    indexNuclides(table, report);
+}
+
+// Function to pan across a full-size chart at each zoom level, drawing
+// each frame culled to the view and, for comparison, by drawing every cell
+void benchChart(int frames) {
+    static NuclideTable table;
+    buildSyntheticNuclides(table);
+    NullBackend backend(WINDOW_WIDTH, WINDOW_HEIGHT);
+    ChartView view = { { baseX, baseY + 10, WINDOW_WIDTH - 230, WINDOW_HEIGHT - 40 }, 0, 0, 0, -1, -1 };
+    cout << "chart of " << table.count << " synthetic nuclides, " << frames << " panned frames per zoom level:" << endl;
+    
+    for(int zoom = 0; zoom < CHART_ZOOM_LEVELS; zoom++) {
+        double ms[2];
+        long long bars[2], texts[2];
+        for(int culled = 1; culled >= 0; culled--) {
+            view.zoom = zoom;
+            view.scrollX = view.scrollY = 0;
+            backend.resetCounters();
+            long long start = timerNow();
+            for(int f = 0; f < frames; f++) {
+                int scrollX = view.scrollX;
+                panChart(view, table, 37, 19);
+                if(view.scrollX == scrollX) view.scrollX = view.scrollY = 0;
+                
+                backend.setFillColor(COLOR_BLACK);
+                backend.bar(view.area.left, view.area.top, view.area.right, view.area.bottom);
+                if(culled) {
+                    drawNuclideChart(&backend, view, table, view.area);
+                } else {
+                    for(int i = 0; i < table.count; i++) drawNuclideCell(&backend, view, table.nuclide[i]);
+                }
+            }
+            ms[culled] = timerMs(timerNow() - start);
+            bars[culled] = backend.counters().bars - frames;
+            texts[culled] = backend.counters().texts;
+        }
+        cout << "  " << CHART_CELL_SIZES[zoom] << " px cells: culled " << (double)bars[1] / frames << " bars + "
+             << (double)texts[1] / frames << " texts, " << ms[1] * 1000.0 / frames << " us/frame; every cell "
+             << (double)bars[0] / frames << " bars + " << (double)texts[0] / frames << " texts, "
+             << ms[0] * 1000.0 / frames << " us/frame" << endl;
+    }
+}
+
+// Function to time one batch of view events and print what it drew
+void timeViewEvents(NullBackend& backend, const char* label, const InputEvent* events, int count, int rounds) {
+    backend.resetCounters();
+    long long start = timerNow();
+    for(int n = 0; n < rounds; n++) {
+        for(int i = 0; i < count; i++) {
+            backend.postEvent(events[i].type, events[i].x, events[i].y, events[i].key);
+            processNextEvent(0);
+        }
+    }
+    double ms = timerMs(timerNow() - start);
+    cout << label << ": " << ms / (rounds * count) << " ms/step" << endl;
+    printCounters(label, backend.counters(), rounds * count);
+}
+
+// Function to time wheel zoom and arrow-key panning on a screen of the
+// given size. Entering a zoom level for the first time rasterizes the
+// tiles in view; going back to one used recently should only blit.
+void benchZoom(int rounds, int width, int height) {
+    NullBackend backend(width, height);
+    logClickLatency = false;
+    initTableView(&backend);
+    cout << width << "x" << height << " screen: table fitted at " << tableCellSize() << " px cells" << endl;
+    
+    // Zoom in from the fitted size, or out if it is the largest already
+    int x = baseX + GRID_COLS * tableCellSize() / 2;
+    int y = baseY + GRID_ROWS * tableCellSize() / 2;
+    int direction = zoomedCellSize(1) > tableCellSize() ? 1 : -1;
+    InputEvent forward = { EVENT_WHEEL, x, y, direction, 0, 0 };
+    InputEvent back = { EVENT_WHEEL, x, y, -direction, 0, 0 };
+    InputEvent away[3] = { forward, forward, forward };
+    InputEvent backAndForth[6] = { back, back, back, forward, forward, forward };
+    InputEvent pan[4];
+    const int arrows[4] = { KEY_LEFT, KEY_UP, KEY_RIGHT, KEY_DOWN };
+    for(int i = 0; i < 4; i++) {
+        InputEvent ev = { EVENT_KEY, 0, 0, arrows[i], 0, 0 };
+        pan[i] = ev;
+    }
+    
+    timeViewEvents(backend, direction > 0 ? "zoom in, cold" : "zoom out, cold", away, 3, 1);
+    cout << "  now at " << tableCellSize() << " px cells" << endl;
+    timeViewEvents(backend, "zoom back and forth, cached", backAndForth, 6, rounds);
+    timeViewEvents(backend, "pan", pan, 4, rounds);
+}
+
+int main(int argc, char* argv[]) {
+    const char* command = argc > 1 ? argv[1] : "validate";
+    
+    if(strcmp(command, "validate") == 0) {
+        int problems = validateElements(ELEMENTS, ELEMENT_COUNT);
+        problems += printDataLoadReport(elementDataReport(), elementDataPath());
+        problems += validateElementData(elementColumns());
+        problems += validateFilterParser(elementColumns());
+        problems += validateFormulaParser(elementColumns());
+        problems += printNuclideLoadReport(nuclideDataReport(), nuclideDataPath());
+        problems += validateNuclideData(nuclideTable());
+        return problems == 0 ? 0 : 1;
+    }
+    
+    if(strcmp(command, "snapshot-build") == 0) {
+        return buildSnapshot(argc > 2 ? argv[2] : snapshotPath());
+    }
+    
+    if(strcmp(command, "snapshot-check") == 0) {
+        return checkSnapshot(argc > 2 ? argv[2] : snapshotPath());
+    }
+    
+    if(strcmp(command, "bench-startup") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 1000;
+        if(iterations <= 0) iterations = 1000;
+        benchStartup(iterations);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench-load") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 1000;
+        if(iterations <= 0) iterations = 1000;
+        benchLoad(iterations);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 100;
+        if(iterations <= 0) iterations = 100;
+        benchHitTesting(iterations);
+        benchRendering(iterations);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench-columns") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 1000000;
+        if(iterations <= 0) iterations = 1000000;
+        benchColumns(iterations);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench-search") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 1000;
+        if(iterations <= 0) iterations = 1000;
+        benchSearch(iterations);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench-animation") == 0) {
+        double seconds = argc > 2 ? atof(argv[2]) : 2;
+        int fps = argc > 3 ? atoi(argv[3]) : 60;
+        if(seconds <= 0) seconds = 2;
+        if(fps <= 0) fps = 60;
+        benchAnimation(seconds, fps);
+        return 0;
+    }
+    
+    if(strcmp(command, "filter") == 0 && argc > 2) {
+        return runFilter(argv[2]);
+    }
+    
+    if(strcmp(command, "compare") == 0 && argc > 3) {
+        return runCompare(argc - 2, argv + 2);
+    }
+    
+    if(strcmp(command, "watch") == 0) {
+        double seconds = argc > 2 ? atof(argv[2]) : 30;
+        if(seconds <= 0) seconds = 30;
+        runWatch(seconds);
+        return 0;
+    }
+    
+    if(strcmp(command, "molar-mass") == 0 && argc > 2) {
+        return runMolarMass(argc - 2, argv + 2);
+    }
+    
+    if(strcmp(command, "formula-batch") == 0 && argc > 2) {
+        return runFormulaBatchCommand(argv[2], argc > 3 ? argv[3] : NULL, argc > 4 ? atoi(argv[4]) : 0);
+    }
+    
+    if(strcmp(command, "bench-formula") == 0) {
+        int count = argc > 2 ? atoi(argv[2]) : 4000000;
+        if(count <= 0) count = 4000000;
+        benchFormula(count);
+        return 0;
+    }
+    
+    if(strcmp(command, "query") == 0) {
+        return runQuery(argc - 2, argv + 2);
+    }
+    
+    if(strcmp(command, "bench-query") == 0) {
+        int count = argc > 2 ? atoi(argv[2]) : 1000000;
+        if(count <= 0) count = 1000000;
+        benchQuery(count);
+        return 0;
+    }
+    
+    if(strcmp(command, "nuclides") == 0 && argc > 2) {
+        return runNuclides(argv[2]);
+    }
+    
+    if(strcmp(command, "bench-chart") == 0) {
+        int frames = argc > 2 ? atoi(argv[2]) : 2000;
+        if(frames <= 0) frames = 2000;
+        benchChart(frames);
+        return 0;
+    }
+    
+    if(strcmp(command, "bench-zoom") == 0) {
+        int rounds = argc > 2 ? atoi(argv[2]) : 100;
+        int width = argc > 3 ? atoi(argv[3]) : WINDOW_WIDTH;
+        int height = argc > 4 ? atoi(argv[4]) : WINDOW_HEIGHT;
+        if(rounds <= 0) rounds = 100;
+        if(width < 800 || height < 600) {
+            cerr << "bench-zoom: the screen must be at least 800x600" << endl;
+            return 2;
+        }
+        benchZoom(rounds, width, height);
+        return 0;
+    }
+    
+    if(strcmp(command, "serve") == 0) {
+        int port = argc > 2 ? atoi(argv[2]) : DEFAULT_SERVER_PORT;
+        return runServe(port, argc > 3 ? atoi(argv[3]) : 0, argc > 4 ? atof(argv[4]) : 0);
+    }
+    
+    if(strcmp(command, "bench-server") == 0) {
+        int connections = argc > 2 ? atoi(argv[2]) : 64;
+        double seconds = argc > 3 ? atof(argv[3]) : 3;
+        if(connections <= 0) connections = 64;
+        if(seconds <= 0) seconds = 3;
+        return benchServer(connections, seconds, argc > 4 ? atoi(argv[4]) : 0);
+    }
+    
+    cerr << "usage: " << argv[0] << " validate | bench-load [iterations] | snapshot-build [path] | snapshot-check [path]"
+         << " | bench-startup [iterations] | bench [iterations] | bench-columns [iterations]"
+         << " | bench-search [iterations] | bench-animation [seconds] [fps]"
+         << " | filter <expression> | compare <symbol> <symbol> ... | watch [seconds]"
+         << " | molar-mass <formula> ... | formula-batch <input> [output] [threads] | bench-formula [formulas]"
+         << " | query [file] [--csv] [--stats] | bench-query [queries]"
+         << " | nuclides <symbol> | bench-chart [frames] | bench-zoom [rounds] [width] [height]"
+         << " | serve [port] [threads] [seconds] | bench-server [connections] [seconds] [threads]" << endl;
+    return 2;
+}
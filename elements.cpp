@@ -0,0 +1,243 @@
+#include "elements.h"
+
+// Lanthanides and actinides are drawn in two extra rows below period 7,
+// starting under group 3
+constexpr bool isInnerTransition(int atomicNumber) {
+    return (atomicNumber >= 57 && atomicNumber <= 71) || (atomicNumber >= 89 && atomicNumber <= 103);
+}
+
+constexpr int tableRow(int atomicNumber, int period) {
+    return isInnerTransition(atomicNumber) ? period + 1 : period - 1;
+}
+
+constexpr int tableColumn(int atomicNumber, int group) {
+    return !isInnerTransition(atomicNumber) ? group - 1
+         : atomicNumber <= 71 ? 2 + (atomicNumber - 57)
+         : 2 + (atomicNumber - 89);
+}
+
+template<int N>
+constexpr void copyText(char* dest, const char (&src)[N]) {
+    for(int i = 0; i < N; i++) dest[i] = src[i];
+}
+
+// Function to build a table entry at compile time; the cell position is
+// derived from period and group
+template<int S, int N, int C, int B>
+constexpr Element makeElement(const char (&symbol)[S], const char (&name)[N], int atomicNumber,
+                              double atomicWeight, const char (&electronConfig)[C], int color,
+                              const char (&block)[B], int period, int group) {
+    static_assert(S <= sizeof(Element::symbol), "symbol does not fit in Element::symbol");
+    static_assert(N <= sizeof(Element::name), "name does not fit in Element::name");
+    static_assert(C <= sizeof(Element::electronConfig), "configuration does not fit in Element::electronConfig");
+    static_assert(B <= sizeof(Element::block), "block does not fit in Element::block");
+    
+    Element elem = {};
+    copyText(elem.symbol, symbol);
+    copyText(elem.name, name);
+    copyText(elem.electronConfig, electronConfig);
+    copyText(elem.block, block);
+    elem.atomicNumber = atomicNumber;
+    elem.atomicWeight = atomicWeight;
+    elem.color = color;
+    elem.period = period;
+    elem.group = group;
+    elem.x = baseX + tableColumn(atomicNumber, group) * boxSize;
+    elem.y = baseY + tableRow(atomicNumber, period) * boxSize;
+    return elem;
+}
+
+// The element table, built at compile time and kept in read-only memory
+constexpr Element ELEMENTS[ELEMENT_COUNT] = {
+    makeElement("H",  "Hydrogen",       1, 1.008,   "1s1",               NONMETAL,         "s", 1,  1),
+    makeElement("He", "Helium",         2, 4.003,   "1s2",               NOBLE_GAS,        "s", 1, 18),
+    makeElement("Li", "Lithium",        3, 6.941,   "2s1",               ALKALI_METAL,     "s", 2,  1),
+    makeElement("Be", "Beryllium",      4, 9.012,   "2s2",               ALKALINE_EARTH,   "s", 2,  2),
+    makeElement("B",  "Boron",          5, 10.811,  "2s2 2p1",           METALLOID,        "p", 2, 13),
+    makeElement("C",  "Carbon",         6, 12.011,  "2s2 2p2",           NONMETAL,         "p", 2, 14),
+    makeElement("N",  "Nitrogen",       7, 14.007,  "2s2 2p3",           NONMETAL,         "p", 2, 15),
+    makeElement("O",  "Oxygen",         8, 15.999,  "2s2 2p4",           NONMETAL,         "p", 2, 16),
+    makeElement("F",  "Fluorine",       9, 18.998,  "2s2 2p5",           NONMETAL,         "p", 2, 17),
+    makeElement("Ne", "Neon",          10, 20.180,  "2s2 2p6",           NOBLE_GAS,        "p", 2, 18),
+    makeElement("Na", "Sodium",        11, 22.990,  "3s1",               ALKALI_METAL,     "s", 3,  1),
+    makeElement("Mg", "Magnesium",     12, 24.305,  "3s2",               ALKALINE_EARTH,   "s", 3,  2),
+    makeElement("Al", "Aluminum",      13, 26.982,  "3s2 3p1",           POST_TRANSITION,  "p", 3, 13),
+    makeElement("Si", "Silicon",       14, 28.086,  "3s2 3p2",           METALLOID,        "p", 3, 14),
+    makeElement("P",  "Phosphorus",    15, 30.974,  "3s2 3p3",           NONMETAL,         "p", 3, 15),
+    makeElement("S",  "Sulfur",        16, 32.065,  "3s2 3p4",           NONMETAL,         "p", 3, 16),
+    makeElement("Cl", "Chlorine",      17, 35.453,  "3s2 3p5",           NONMETAL,         "p", 3, 17),
+    makeElement("Ar", "Argon",         18, 39.948,  "3s2 3p6",           NOBLE_GAS,        "p", 3, 18),
+    makeElement("K",  "Potassium",     19, 39.098,  "4s1",               ALKALI_METAL,     "s", 4,  1),
+    makeElement("Ca", "Calcium",       20, 40.078,  "4s2",               ALKALINE_EARTH,   "s", 4,  2),
+    makeElement("Sc", "Scandium",      21, 44.956,  "3d1 4s2",           TRANSITION_METAL, "d", 4,  3),
+    makeElement("Ti", "Titanium",      22, 47.867,  "3d2 4s2",           TRANSITION_METAL, "d", 4,  4),
+    makeElement("V",  "Vanadium",      23, 50.942,  "3d3 4s2",           TRANSITION_METAL, "d", 4,  5),
+    makeElement("Cr", "Chromium",      24, 51.996,  "3d5 4s1",           TRANSITION_METAL, "d", 4,  6),
+    makeElement("Mn", "Manganese",     25, 54.938,  "3d5 4s2",           TRANSITION_METAL, "d", 4,  7),
+    makeElement("Fe", "Iron",          26, 55.845,  "3d6 4s2",           TRANSITION_METAL, "d", 4,  8),
+    makeElement("Co", "Cobalt",        27, 58.933,  "3d7 4s2",           TRANSITION_METAL, "d", 4,  9),
+    makeElement("Ni", "Nickel",        28, 58.693,  "3d8 4s2",           TRANSITION_METAL, "d", 4, 10),
+    makeElement("Cu", "Copper",        29, 63.546,  "3d10 4s1",          TRANSITION_METAL, "d", 4, 11),
+    makeElement("Zn", "Zinc",          30, 65.38,   "3d10 4s2",          TRANSITION_METAL, "d", 4, 12),
+    makeElement("Ga", "Gallium",       31, 69.723,  "3d10 4s2 4p1",      POST_TRANSITION,  "p", 4, 13),
+    makeElement("Ge", "Germanium",     32, 72.64,   "3d10 4s2 4p2",      METALLOID,        "p", 4, 14),
+    makeElement("As", "Arsenic",       33, 74.922,  "3d10 4s2 4p3",      METALLOID,        "p", 4, 15),
+    makeElement("Se", "Selenium",      34, 78.96,   "3d10 4s2 4p4",      NONMETAL,         "p", 4, 16),
+    makeElement("Br", "Bromine",       35, 79.904,  "3d10 4s2 4p5",      NONMETAL,         "p", 4, 17),
+    makeElement("Kr", "Krypton",       36, 83.798,  "3d10 4s2 4p6",      NOBLE_GAS,        "p", 4, 18),
+    makeElement("Rb", "Rubidium",      37, 85.468,  "5s1",               ALKALI_METAL,     "s", 5,  1),
+    makeElement("Sr", "Strontium",     38, 87.62,   "5s2",               ALKALINE_EARTH,   "s", 5,  2),
+    makeElement("Y",  "Yttrium",       39, 88.906,  "4d1 5s2",           TRANSITION_METAL, "d", 5,  3),
+    makeElement("Zr", "Zirconium",     40, 91.224,  "4d2 5s2",           TRANSITION_METAL, "d", 5,  4),
+    makeElement("Nb", "Niobium",       41, 92.906,  "4d4 5s1",           TRANSITION_METAL, "d", 5,  5),
+    makeElement("Mo", "Molybdenum",    42, 95.96,   "4d5 5s1",           TRANSITION_METAL, "d", 5,  6),
+    makeElement("Tc", "Technetium",    43, 98,      "4d5 5s2",           TRANSITION_METAL, "d", 5,  7),
+    makeElement("Ru", "Ruthenium",     44, 101.07,  "4d7 5s1",           TRANSITION_METAL, "d", 5,  8),
+    makeElement("Rh", "Rhodium",       45, 102.91,  "4d8 5s1",           TRANSITION_METAL, "d", 5,  9),
+    makeElement("Pd", "Palladium",     46, 106.42,  "4d10",              TRANSITION_METAL, "d", 5, 10),
+    makeElement("Ag", "Silver",        47, 107.87,  "4d10 5s1",          TRANSITION_METAL, "d", 5, 11),
+    makeElement("Cd", "Cadmium",       48, 112.41,  "4d10 5s2",          TRANSITION_METAL, "d", 5, 12),
+    makeElement("In", "Indium",        49, 114.82,  "4d10 5s2 5p1",      POST_TRANSITION,  "p", 5, 13),
+    makeElement("Sn", "Tin",           50, 118.71,  "4d10 5s2 5p2",      POST_TRANSITION,  "p", 5, 14),
+    makeElement("Sb", "Antimony",      51, 121.76,  "4d10 5s2 5p3",      METALLOID,        "p", 5, 15),
+    makeElement("Te", "Tellurium",     52, 127.60,  "4d10 5s2 5p4",      METALLOID,        "p", 5, 16),
+    makeElement("I",  "Iodine",        53, 126.90,  "4d10 5s2 5p5",      NONMETAL,         "p", 5, 17),
+    makeElement("Xe", "Xenon",         54, 131.29,  "4d10 5s2 5p6",      NOBLE_GAS,        "p", 5, 18),
+    makeElement("Cs", "Cesium",        55, 132.91,  "6s1",               ALKALI_METAL,     "s", 6,  1),
+    makeElement("Ba", "Barium",        56, 137.33,  "6s2",               ALKALINE_EARTH,   "s", 6,  2),
+    makeElement("La", "Lanthanum",     57, 138.91,  "5d1 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Ce", "Cerium",        58, 140.12,  "4f1 5d1 6s2",       LANTHANIDE,       "f", 6,  3),
+    makeElement("Pr", "Praseodymium",  59, 140.91,  "4f3 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Nd", "Neodymium",     60, 144.24,  "4f4 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Pm", "Promethium",    61, 145,     "4f5 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Sm", "Samarium",      62, 150.36,  "4f6 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Eu", "Europium",      63, 151.96,  "4f7 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Gd", "Gadolinium",    64, 157.25,  "4f7 5d1 6s2",       LANTHANIDE,       "f", 6,  3),
+    makeElement("Tb", "Terbium",       65, 158.93,  "4f9 6s2",           LANTHANIDE,       "f", 6,  3),
+    makeElement("Dy", "Dysprosium",    66, 162.50,  "4f10 6s2",          LANTHANIDE,       "f", 6,  3),
+    makeElement("Ho", "Holmium",       67, 164.93,  "4f11 6s2",          LANTHANIDE,       "f", 6,  3),
+    makeElement("Er", "Erbium",        68, 167.26,  "4f12 6s2",          LANTHANIDE,       "f", 6,  3),
+    makeElement("Tm", "Thulium",       69, 168.93,  "4f13 6s2",          LANTHANIDE,       "f", 6,  3),
+    makeElement("Yb", "Ytterbium",     70, 173.05,  "4f14 6s2",          LANTHANIDE,       "f", 6,  3),
+    makeElement("Lu", "Lutetium",      71, 174.97,  "4f14 5d1 6s2",      LANTHANIDE,       "f", 6,  3),
+    makeElement("Hf", "Hafnium",       72, 178.49,  "4f14 5d2 6s2",      TRANSITION_METAL, "d", 6,  4),
+    makeElement("Ta", "Tantalum",      73, 180.95,  "4f14 5d3 6s2",      TRANSITION_METAL, "d", 6,  5),
+    makeElement("W",  "Tungsten",      74, 183.84,  "4f14 5d4 6s2",      TRANSITION_METAL, "d", 6,  6),
+    makeElement("Re", "Rhenium",       75, 186.21,  "4f14 5d5 6s2",      TRANSITION_METAL, "d", 6,  7),
+    makeElement("Os", "Osmium",        76, 190.23,  "4f14 5d6 6s2",      TRANSITION_METAL, "d", 6,  8),
+    makeElement("Ir", "Iridium",       77, 192.22,  "4f14 5d7 6s2",      TRANSITION_METAL, "d", 6,  9),
+    makeElement("Pt", "Platinum",      78, 195.08,  "4f14 5d9 6s1",      TRANSITION_METAL, "d", 6, 10),
+    makeElement("Au", "Gold",          79, 196.97,  "4f14 5d10 6s1",     TRANSITION_METAL, "d", 6, 11),
+    makeElement("Hg", "Mercury",       80, 200.59,  "4f14 5d10 6s2",     TRANSITION_METAL, "d", 6, 12),
+    makeElement("Tl", "Thallium",      81, 204.38,  "4f14 5d10 6s2 6p1", POST_TRANSITION,  "p", 6, 13),
+    makeElement("Pb", "Lead",          82, 207.2,   "4f14 5d10 6s2 6p2", POST_TRANSITION,  "p", 6, 14),
+    makeElement("Bi", "Bismuth",       83, 208.98,  "4f14 5d10 6s2 6p3", POST_TRANSITION,  "p", 6, 15),
+    makeElement("Po", "Polonium",      84, 209,     "4f14 5d10 6s2 6p4", POST_TRANSITION,  "p", 6, 16),
+    makeElement("At", "Astatine",      85, 210,     "4f14 5d10 6s2 6p5", METALLOID,        "p", 6, 17),
+    makeElement("Rn", "Radon",         86, 222,     "4f14 5d10 6s2 6p6", NOBLE_GAS,        "p", 6, 18),
+    makeElement("Fr", "Francium",      87, 223,     "7s1",               ALKALI_METAL,     "s", 7,  1),
+    makeElement("Ra", "Radium",        88, 226,     "7s2",               ALKALINE_EARTH,   "s", 7,  2),
+    makeElement("Ac", "Actinium",      89, 227,     "6d1 7s2",           ACTINIDE,         "f", 7,  3),
+    makeElement("Th", "Thorium",       90, 232.04,  "6d2 7s2",           ACTINIDE,         "f", 7,  3),
+    makeElement("Pa", "Protactinium",  91, 231.04,  "5f2 6d1 7s2",       ACTINIDE,         "f", 7,  3),
+    makeElement("U",  "Uranium",       92, 238.03,  "5f3 6d1 7s2",       ACTINIDE,         "f", 7,  3),
+    makeElement("Np", "Neptunium",     93, 237,     "5f4 6d1 7s2",       ACTINIDE,         "f", 7,  3),
+    makeElement("Pu", "Plutonium",     94, 244,     "5f6 7s2",           ACTINIDE,         "f", 7,  3),
+    makeElement("Am", "Americium",     95, 243,     "5f7 7s2",           ACTINIDE,         "f", 7,  3),
+    makeElement("Cm", "Curium",        96, 247,     "5f7 6d1 7s2",       ACTINIDE,         "f", 7,  3),
+    makeElement("Bk", "Berkelium",     97, 247,     "5f9 7s2",           ACTINIDE,         "f", 7,  3),
+    makeElement("Cf", "Californium",   98, 251,     "5f10 7s2",          ACTINIDE,         "f", 7,  3),
+    makeElement("Es", "Einsteinium",   99, 252,     "5f11 7s2",          ACTINIDE,         "f", 7,  3),
+    makeElement("Fm", "Fermium",      100, 257,     "5f12 7s2",          ACTINIDE,         "f", 7,  3),
+    makeElement("Md", "Mendelevium",  101, 258,     "5f13 7s2",          ACTINIDE,         "f", 7,  3),
+    makeElement("No", "Nobelium",     102, 259,     "5f14 7s2",          ACTINIDE,         "f", 7,  3),
+    makeElement("Lr", "Lawrencium",   103, 266,     "5f14 7s2 7p1",      ACTINIDE,         "f", 7,  3),
+    makeElement("Rf", "Rutherfordium", 104, 267,     "5f14 6d2 7s2",      TRANSITION_METAL, "d", 7,  4),
+    makeElement("Db", "Dubnium",      105, 268,     "5f14 6d3 7s2",      TRANSITION_METAL, "d", 7,  5),
+    makeElement("Sg", "Seaborgium",   106, 269,     "5f14 6d4 7s2",      TRANSITION_METAL, "d", 7,  6),
+    makeElement("Bh", "Bohrium",      107, 270,     "5f14 6d5 7s2",      TRANSITION_METAL, "d", 7,  7),
+    makeElement("Hs", "Hassium",      108, 277,     "5f14 6d6 7s2",      TRANSITION_METAL, "d", 7,  8),
+    makeElement("Mt", "Meitnerium",   109, 278,     "5f14 6d7 7s2",      TRANSITION_METAL, "d", 7,  9),
+    makeElement("Ds", "Darmstadtium", 110, 281,     "5f14 6d8 7s2",      TRANSITION_METAL, "d", 7, 10),
+    makeElement("Rg", "Roentgenium",  111, 282,     "5f14 6d9 7s2",      TRANSITION_METAL, "d", 7, 11),
+    makeElement("Cn", "Copernicium",  112, 285,     "5f14 6d10 7s2",     TRANSITION_METAL, "d", 7, 12),
+    makeElement("Nh", "Nihonium",     113, 286,     "5f14 6d10 7s2 7p1", POST_TRANSITION,  "p", 7, 13),
+    makeElement("Fl", "Flerovium",    114, 289,     "5f14 6d10 7s2 7p2", POST_TRANSITION,  "p", 7, 14),
+    makeElement("Mc", "Moscovium",    115, 290,     "5f14 6d10 7s2 7p3", POST_TRANSITION,  "p", 7, 15),
+    makeElement("Lv", "Livermorium",  116, 293,     "5f14 6d10 7s2 7p4", POST_TRANSITION,  "p", 7, 16),
+    makeElement("Ts", "Tennessine",   117, 294,     "5f14 6d10 7s2 7p5", POST_TRANSITION,  "p", 7, 17),
+    makeElement("Og", "Oganesson",    118, 294,     "5f14 6d10 7s2 7p6", NOBLE_GAS,        "p", 7, 18)
+};
+
+constexpr bool atomicNumbersOrdered() {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(ELEMENTS[i].atomicNumber != i + 1) return false;
+    }
+    return true;
+}
+
+constexpr bool symbolsPresent() {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(ELEMENTS[i].symbol[0] == '\0') return false;
+    }
+    return true;
+}
+
+constexpr bool cellsDisjoint() {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        for(int j = i + 1; j < ELEMENT_COUNT; j++) {
+            int dx = ELEMENTS[i].x - ELEMENTS[j].x;
+            int dy = ELEMENTS[i].y - ELEMENTS[j].y;
+            if(dx > -boxSize && dx < boxSize && dy > -boxSize && dy < boxSize) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(atomicNumbersOrdered(), "ELEMENTS must list H to Og by atomic number with no gaps or repeats");
+static_assert(symbolsPresent(), "every element needs a symbol");
+static_assert(cellsDisjoint(), "two elements share a table cell");
+
+constexpr SymbolHashTable buildSymbolHash() {
+    SymbolHashTable table = {};
+    for(int i = 0; i < SYMBOL_HASH_SIZE; i++) table.slot[i] = -1;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        table.slot[symbolHash(ELEMENTS[i].symbol[0], ELEMENTS[i].symbol[1])] = (signed char)i;
+    }
+    return table;
+}
+
+constexpr SymbolHashTable SYMBOL_HASH = buildSymbolHash();
+
+// A later symbol overwriting an earlier one would leave it unreachable
+constexpr bool symbolHashPerfect() {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(SYMBOL_HASH.slot[symbolHash(ELEMENTS[i].symbol[0], ELEMENTS[i].symbol[1])] != i) return false;
+    }
+    return true;
+}
+
+static_assert(symbolHashPerfect(), "two symbols collide in SYMBOL_HASH; pick a new multiplier in symbolHash");
+
+constexpr bool symbolsCapitalized() {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        char upper = ELEMENTS[i].symbol[0];
+        char lower = ELEMENTS[i].symbol[1];
+        if(upper < 'A' || upper > 'Z') return false;
+        if(lower != '\0' && (lower < 'a' || lower > 'z' || ELEMENTS[i].symbol[2] != '\0')) return false;
+    }
+    return true;
+}
+
+static_assert(symbolsCapitalized(), "symbols must be a capital letter and at most one lower-case letter");
+
+constexpr SymbolIndexTable buildSymbolIndex() {
+    SymbolIndexTable table = {};
+    for(int i = 0; i < SYMBOL_INDEX_SIZE; i++) table.slot[i] = -1;
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        table.slot[symbolSlot(ELEMENTS[i].symbol[0], ELEMENTS[i].symbol[1])] = (signed char)i;
+    }
+    return table;
+}
+
+constexpr SymbolIndexTable SYMBOL_INDEX = buildSymbolIndex();
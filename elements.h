@@ -0,0 +1,101 @@
+#ifndef ELEMENTS_H
+#define ELEMENTS_H
+
+// Element data and table layout. Nothing here depends on a graphics library;
+// colors are numbers from the 16-color BGI palette, which every rendering
+// backend understands. Measured properties (radius, electronegativity,
+// ionization energy, ...) are not compiled in; they are loaded from the
+// element data file into ElementColumns, see element_data.h.
+
+struct Element {
+    char symbol[3];      
+    char name[20];        
+    int atomicNumber;
+    double atomicWeight;
+    char electronConfig[30]; 
+    int color;
+    int x;
+    int y;
+    char block[2];       
+    int period;
+    int group;
+};
+
+// Layout coordinates: cells are boxSize apart from (baseX, baseY). The view
+// scales and moves them onto the screen (ViewTransform in element_query.h),
+// and the window is WINDOW_WIDTH x WINDOW_HEIGHT unless sized otherwise.
+const int boxSize = 60;
+const int baseX = 50;
+const int baseY = 30;
+const int WINDOW_WIDTH = 1400;
+const int WINDOW_HEIGHT = 900;
+
+// Table grid: 7 periods plus the lanthanide and actinide rows
+const int GRID_ROWS = 9;
+const int GRID_COLS = 18;
+
+enum PaletteColor {
+    COLOR_BLACK,
+    COLOR_BLUE,
+    COLOR_GREEN,
+    COLOR_CYAN,
+    COLOR_RED,
+    COLOR_MAGENTA,
+    COLOR_BROWN,
+    COLOR_LIGHTGRAY,
+    COLOR_DARKGRAY,
+    COLOR_LIGHTBLUE,
+    COLOR_LIGHTGREEN,
+    COLOR_LIGHTCYAN,
+    COLOR_LIGHTRED,
+    COLOR_LIGHTMAGENTA,
+    COLOR_YELLOW,
+    COLOR_WHITE
+};
+
+const int ALKALI_METAL = COLOR_LIGHTBLUE;
+const int ALKALINE_EARTH = COLOR_LIGHTMAGENTA;
+const int TRANSITION_METAL = COLOR_LIGHTGRAY;
+const int POST_TRANSITION = COLOR_YELLOW;
+const int METALLOID = COLOR_BROWN;
+const int NONMETAL = COLOR_LIGHTGREEN;
+const int NOBLE_GAS = COLOR_LIGHTRED;
+const int LANTHANIDE = COLOR_CYAN;
+const int ACTINIDE = COLOR_LIGHTCYAN;
+
+const int ELEMENT_COUNT = 118;
+extern const Element ELEMENTS[ELEMENT_COUNT];
+
+// Perfect hash over the 118 symbols, built at compile time next to the
+// table: every symbol lands in its own slot, so an exact symbol lookup is
+// one multiply, one load and one compare (see findSymbol).
+const int SYMBOL_HASH_BITS = 9;
+const int SYMBOL_HASH_SIZE = 1 << SYMBOL_HASH_BITS;
+
+constexpr unsigned symbolHash(char first, char second) {
+    return (((unsigned)(unsigned char)first << 8 | (unsigned char)second) * 0xBB4FAF21u & 0xFFFFFFFFu)
+           >> (32 - SYMBOL_HASH_BITS);
+}
+
+struct SymbolHashTable {
+    signed char slot[SYMBOL_HASH_SIZE];  // element index, -1 if empty
+};
+
+extern const SymbolHashTable SYMBOL_HASH;
+
+// Case-sensitive symbol table for the formula parser, indexed directly by
+// the capital letter and the optional lower-case letter after it: "Co" is
+// cobalt, "CO" is carbon then oxygen. A lookup is one load, no compare.
+const int SYMBOL_INDEX_SIZE = 26 * 27;
+
+constexpr int symbolSlot(char upper, char lower) {
+    return (upper - 'A') * 27 + (lower == '\0' ? 0 : lower - 'a' + 1);
+}
+
+struct SymbolIndexTable {
+    signed char slot[SYMBOL_INDEX_SIZE];  // element index, -1 if no such symbol
+};
+
+extern const SymbolIndexTable SYMBOL_INDEX;
+
+#endif
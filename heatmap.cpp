@@ -0,0 +1,111 @@
+#include "heatmap.h"
+#include <cmath>
+#include <algorithm>
+
+// ---------------------------------------------------------------------------
+// Color ramp, interpolated at compile time between a few stops
+// ---------------------------------------------------------------------------
+
+const int RAMP_STOP_COUNT = 5;
+
+constexpr RampColor RAMP_STOPS[RAMP_STOP_COUNT] = {
+    { 69, 117, 180 },
+    { 145, 191, 219 },
+    { 255, 255, 191 },
+    { 252, 141, 89 },
+    { 215, 48, 39 }
+};
+
+// Rounds to nearest in both directions; plain division truncates toward zero
+constexpr unsigned char mixChannel(int from, int to, int step, int steps) {
+    int change = (to - from) * step;
+    return (unsigned char)(from + (change >= 0 ? change + steps / 2 : change - steps / 2) / steps);
+}
+
+constexpr HeatmapRamp buildHeatmapRamp() {
+    HeatmapRamp ramp = {};
+    const int segments = RAMP_STOP_COUNT - 1;
+    for(int i = 0; i < HEATMAP_STEPS; i++) {
+        // Position of step i along the stops, in units of 1/(HEATMAP_STEPS-1)
+        int position = i * segments;
+        int stop = position / (HEATMAP_STEPS - 1);
+        int step = position % (HEATMAP_STEPS - 1);
+        if(stop == segments) {
+            stop = segments - 1;
+            step = HEATMAP_STEPS - 1;
+        }
+        const RampColor& from = RAMP_STOPS[stop];
+        const RampColor& to = RAMP_STOPS[stop + 1];
+        ramp.color[i].red = mixChannel(from.red, to.red, step, HEATMAP_STEPS - 1);
+        ramp.color[i].green = mixChannel(from.green, to.green, step, HEATMAP_STEPS - 1);
+        ramp.color[i].blue = mixChannel(from.blue, to.blue, step, HEATMAP_STEPS - 1);
+    }
+    return ramp;
+}
+
+constexpr HeatmapRamp HEATMAP_RAMP = buildHeatmapRamp();
+
+static_assert(HEATMAP_RAMP.color[0].red == 69 && HEATMAP_RAMP.color[HEATMAP_STEPS - 1].red == 215,
+              "heatmap ramp must start and end on the first and last stops");
+
+// ---------------------------------------------------------------------------
+// Normalization
+// ---------------------------------------------------------------------------
+
+int heatmapLevel(const PropertyScale& scale, double value) {
+    if(std::isnan(value) || scale.count == 0) return -1;
+    
+    const double* q = scale.quantile;
+    if(value <= q[0]) return 0;
+    if(value >= q[HEATMAP_QUANTILES]) return HEATMAP_STEPS - 1;
+    
+    // Knots are sorted, so the first one above the value closes its segment
+    int k = 0;
+    while(k + 1 < HEATMAP_QUANTILES && value >= q[k + 1]) k++;
+    double width = q[k + 1] - q[k];
+    double t = width > 0 ? (value - q[k]) / width : 0;
+    double position = (k + t) / HEATMAP_QUANTILES;
+    return (int)(position * (HEATMAP_STEPS - 1) + 0.5);
+}
+
+void buildHeatmapTable(const ElementColumns& columns, HeatmapTable& table) {
+    for(int p = 0; p < PROP_COUNT; p++) {
+        const double* column = propertyColumn(columns, p);
+        PropertyScale& scale = table.scale[p];
+        
+        double sorted[COLUMN_CAPACITY];
+        int count = 0;
+        for(int i = 0; i < columns.count; i++) {
+            if(!std::isnan(column[i])) sorted[count++] = column[i];
+        }
+        std::sort(sorted, sorted + count);
+        
+        // Quantiles by linear interpolation between the closest ranks
+        scale.count = count;
+        for(int k = 0; k <= HEATMAP_QUANTILES; k++) {
+            if(count == 0) {
+                scale.quantile[k] = 0;
+                continue;
+            }
+            double rank = (double)(count - 1) * k / HEATMAP_QUANTILES;
+            int below = (int)rank;
+            int above = below + 1 < count ? below + 1 : below;
+            scale.quantile[k] = sorted[below] + (sorted[above] - sorted[below]) * (rank - below);
+        }
+        
+        for(int i = 0; i < COLUMN_CAPACITY; i++) {
+            table.level[p][i] = (signed char)(i < columns.count ? heatmapLevel(scale, column[i]) : -1);
+        }
+    }
+}
+
+const HeatmapTable& heatmapTable() {
+    static HeatmapTable table;
+    static unsigned builtFor = 0;
+    unsigned generation = elementColumnsGeneration();
+    if(builtFor != generation) {
+        buildHeatmapTable(elementColumns(), table);
+        builtFor = generation;
+    }
+    return table;
+}
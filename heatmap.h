@@ -0,0 +1,48 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "element_columns.h"
+
+// Heatmap coloring of the table by a numeric property. Every property is
+// normalized once: each element gets a level 0..HEATMAP_STEPS-1 that indexes
+// a fixed color ramp. Levels are interpolated between the property's
+// quantiles rather than between min and max alone, so a few outliers (the
+// superheavy weights) don't squash everything else into one end of the ramp.
+
+const int HEATMAP_STEPS = 32;
+const int HEATMAP_QUANTILES = 8;  // knots at 0, 1/8, ..., 8/8
+
+struct RampColor {
+    unsigned char red;
+    unsigned char green;
+    unsigned char blue;
+};
+
+// Cool-to-warm ramp, light enough at both ends for black text
+struct HeatmapRamp {
+    RampColor color[HEATMAP_STEPS];
+};
+
+extern const HeatmapRamp HEATMAP_RAMP;
+
+struct PropertyScale {
+    int count;                                // elements with a value
+    double quantile[HEATMAP_QUANTILES + 1];  // [0] is the min, [HEATMAP_QUANTILES] the max
+};
+
+struct HeatmapTable {
+    PropertyScale scale[PROP_COUNT];
+    signed char level[PROP_COUNT][COLUMN_CAPACITY];  // -1 where the value is missing
+};
+
+// Function to normalize every property of the columns
+void buildHeatmapTable(const ElementColumns& columns, HeatmapTable& table);
+
+// The table for elementColumns(), rebuilt on first use after the columns
+// are reloaded. UI thread only.
+const HeatmapTable& heatmapTable();
+
+// Function to map a value onto the ramp (-1 for NaN or an empty scale)
+int heatmapLevel(const PropertyScale& scale, double value);
+
+#endif
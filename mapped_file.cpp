@@ -0,0 +1,97 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// An empty file maps to a non-NULL empty view, since mmap rejects length 0
+static const char EMPTY_FILE[1] = { 0 };
+
+#ifdef _WIN32
+
+bool mapFile(const char* path, MappedFile& file) {
+    file.data = NULL;
+    file.size = 0;
+    file.handle = NULL;
+    
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(handle == INVALID_HANDLE_VALUE) return false;
+    
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return false;
+    }
+    if(size.QuadPart == 0) {
+        CloseHandle(handle);
+        file.data = EMPTY_FILE;
+        return true;
+    }
+    
+    // The view keeps the mapping alive, so both handles can go now
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if(mapping == NULL) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(view == NULL) return false;
+    
+    file.data = (const char*)view;
+    file.size = (size_t)size.QuadPart;
+    file.handle = view;
+    return true;
+}
+
+void unmapFile(MappedFile& file) {
+    if(file.handle != NULL) UnmapViewOfFile(file.handle);
+    file.data = NULL;
+    file.size = 0;
+    file.handle = NULL;
+}
+
+#else
+
+bool mapFile(const char* path, MappedFile& file) {
+    file.data = NULL;
+    file.size = 0;
+    file.handle = NULL;
+    
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return false;
+    
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    if(info.st_size == 0) {
+        close(fd);
+        file.data = EMPTY_FILE;
+        return true;
+    }
+    
+    // The mapping outlives the descriptor
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(view == MAP_FAILED) return false;
+    
+    file.data = (const char*)view;
+    file.size = (size_t)info.st_size;
+    file.handle = view;
+    return true;
+}
+
+void unmapFile(MappedFile& file) {
+    if(file.handle != NULL) munmap(file.handle, file.size);
+    file.data = NULL;
+    file.size = 0;
+    file.handle = NULL;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+// Read-only view of a whole file mapped into memory, so it can be parsed in
+// place without a copy. The view is not NUL-terminated; parsers must stop
+// at data + size.
+struct MappedFile {
+    const char* data;
+    size_t size;
+    void* handle;  // platform mapping state, NULL when nothing is mapped
+};
+
+// Function to map a file; returns false (and leaves file empty) if it can't
+bool mapFile(const char* path, MappedFile& file);
+
+void unmapFile(MappedFile& file);
+
+#endif
@@ -0,0 +1,210 @@
+#include "nuclide_chart.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+const int DECAY_COLORS[DECAY_MODE_COUNT] = {
+    COLOR_WHITE,         // stable
+    COLOR_LIGHTBLUE,     // beta-
+    COLOR_LIGHTRED,      // beta+/EC
+    COLOR_YELLOW,        // alpha
+    COLOR_LIGHTGREEN,    // fission
+    COLOR_LIGHTMAGENTA,  // proton
+    COLOR_CYAN,          // neutron
+    COLOR_LIGHTGRAY,     // isomeric
+    COLOR_DARKGRAY       // unknown
+};
+
+// Empty columns kept right of the heaviest nuclide
+const int CHART_MARGIN_CELLS = 4;
+
+int decayColor(int mode) {
+    return mode >= 0 && mode < DECAY_MODE_COUNT ? DECAY_COLORS[mode] : COLOR_DARKGRAY;
+}
+
+int chartCellSize(const ChartView& view) {
+    return CHART_CELL_SIZES[view.zoom];
+}
+
+Rect chartCellRect(const ChartView& view, int n, int z) {
+    int cell = chartCellSize(view);
+    int left = view.area.left + n * cell - view.scrollX;
+    int bottom = view.area.bottom - (z * cell - view.scrollY);
+    Rect r = { left, bottom - cell + 1, left + cell - 1, bottom };
+    return r;
+}
+
+int chartNuclideAt(const ChartView& view, const NuclideTable& table, int x, int y) {
+    const Rect& a = view.area;
+    if(x < a.left || x > a.right || y < a.top || y > a.bottom) return -1;
+    int cell = chartCellSize(view);
+    int n = (x - a.left + view.scrollX) / cell;
+    int z = (a.bottom - y + view.scrollY) / cell;
+    return findNuclide(table, z, n);
+}
+
+// Function to keep the scroll position inside the chart
+static void clampScroll(ChartView& view, const NuclideTable& table) {
+    int cell = chartCellSize(view);
+    int width = (table.maxN + 1 + CHART_MARGIN_CELLS) * cell;
+    int height = (ELEMENT_COUNT + 1) * cell;
+    int maxX = max(0, width - (view.area.right - view.area.left + 1));
+    int maxY = max(0, height - (view.area.bottom - view.area.top + 1));
+    view.scrollX = max(0, min(maxX, view.scrollX));
+    view.scrollY = max(0, min(maxY, view.scrollY));
+}
+
+void panChart(ChartView& view, const NuclideTable& table, int dx, int dy) {
+    view.scrollX += dx;
+    view.scrollY += dy;
+    clampScroll(view, table);
+}
+
+void zoomChart(ChartView& view, const NuclideTable& table, int steps, int x, int y) {
+    int oldCell = chartCellSize(view);
+    view.zoom = max(0, min(CHART_ZOOM_LEVELS - 1, view.zoom + steps));
+    int cell = chartCellSize(view);
+    
+    // The chart point under (x, y), in cells, stays under it
+    double chartX = (double)(x - view.area.left + view.scrollX) / oldCell;
+    double chartY = (double)(view.area.bottom - y + view.scrollY) / oldCell;
+    view.scrollX = (int)lround(chartX * cell) - (x - view.area.left);
+    view.scrollY = (int)lround(chartY * cell) - (view.area.bottom - y);
+    clampScroll(view, table);
+}
+
+void centerChart(ChartView& view, const NuclideTable& table, int n, int z) {
+    int cell = chartCellSize(view);
+    view.scrollX = n * cell + cell / 2 - (view.area.right - view.area.left + 1) / 2;
+    view.scrollY = z * cell + cell / 2 - (view.area.bottom - view.area.top + 1) / 2;
+    clampScroll(view, table);
+}
+
+static bool clipRect(Rect& r, const Rect& clip) {
+    r.left = max(r.left, clip.left);
+    r.top = max(r.top, clip.top);
+    r.right = min(r.right, clip.right);
+    r.bottom = min(r.bottom, clip.bottom);
+    return r.left <= r.right && r.top <= r.bottom;
+}
+
+static bool insideRect(const Rect& inner, const Rect& outer) {
+    return inner.left >= outer.left && inner.right <= outer.right &&
+           inner.top >= outer.top && inner.bottom <= outer.bottom;
+}
+
+// Function to write a cell's labels; how many depends on the cell size
+static void drawCellText(RenderBackend* gfx, const Rect& r, int cell, const Nuclide& nuclide) {
+    char text[24];
+    const Element& elem = ELEMENTS[nuclide.z - 1];
+    gfx->setColor(COLOR_BLACK);
+    if(cell < CHART_DETAIL_CELL) {
+        gfx->setTextStyle(FONT_SMALL, 4);
+        gfx->text(r.left + 3, r.top + cell / 2 - 6, elem.symbol);
+        return;
+    }
+    
+    gfx->setTextStyle(FONT_SMALL, 5);
+    snprintf(text, sizeof(text), "%d%s", nuclide.z + nuclide.n, elem.symbol);
+    gfx->text(r.left + 3, r.top + 3, text);
+    
+    gfx->setTextStyle(FONT_SMALL, 4);
+    formatHalfLife(text, sizeof(text), nuclide.halfLife);
+    gfx->text(r.left + 3, r.top + 19, text);
+    if(nuclide.abundance > 0) {
+        snprintf(text, sizeof(text), "%.3g%%", nuclide.abundance);
+        gfx->text(r.left + 3, r.top + 32, text);
+    }
+}
+
+void drawNuclideCell(RenderBackend* gfx, const ChartView& view, const Nuclide& nuclide) {
+    int cell = chartCellSize(view);
+    Rect r = chartCellRect(view, nuclide.n, nuclide.z);
+    gfx->setFillColor(decayColor(nuclide.decay));
+    if(cell < CHART_GAP_CELL) gfx->bar(r.left, r.top, r.right, r.bottom);
+    else gfx->bar(r.left, r.top + 1, r.right - 1, r.bottom);
+    if(cell >= CHART_SYMBOL_CELL) drawCellText(gfx, r, cell, nuclide);
+}
+
+// Function to outline a cell if it is in the view
+static void outlineCell(RenderBackend* gfx, const ChartView& view, const NuclideTable& table, int index, int color) {
+    if(index < 0 || index >= table.count) return;
+    const Nuclide& nuclide = table.nuclide[index];
+    Rect r = chartCellRect(view, nuclide.n, nuclide.z);
+    Rect outline = { r.left - 1, r.top - 1, r.right + 1, r.bottom + 1 };
+    if(!insideRect(outline, view.area)) return;
+    gfx->setLineWidth(LINE_NORMAL);
+    gfx->setColor(color);
+    gfx->rectangle(outline.left, outline.top, outline.right, outline.bottom);
+}
+
+int drawNuclideChart(RenderBackend* gfx, const ChartView& view, const NuclideTable& table, const Rect& clip) {
+    Rect r = clip;
+    if(!clipRect(r, view.area)) return 0;
+    
+    // Rows and columns the clip rectangle covers
+    int cell = chartCellSize(view);
+    int nMin = (r.left - view.area.left + view.scrollX) / cell;
+    int nMax = (r.right - view.area.left + view.scrollX) / cell;
+    int zMin = max(1, (view.area.bottom - r.bottom + view.scrollY) / cell);
+    int zMax = min(ELEMENT_COUNT, (view.area.bottom - r.top + view.scrollY) / cell);
+    
+    int bars = 0;
+    for(int z = zMin; z <= zMax; z++) {
+        int end = table.first[z + 1];
+        int i = firstNuclideFrom(table, z, nMin);
+        
+        if(cell < CHART_GAP_CELL) {
+            // Too small for text or gaps: one bar per run of one color
+            while(i < end && table.nuclide[i].n <= nMax) {
+                int color = decayColor(table.nuclide[i].decay);
+                int firstN = table.nuclide[i].n;
+                int lastN = firstN;
+                for(i++; i < end && table.nuclide[i].n == lastN + 1 && lastN < nMax; i++) {
+                    if(decayColor(table.nuclide[i].decay) != color) break;
+                    lastN++;
+                }
+                Rect run = chartCellRect(view, firstN, z);
+                run.right = chartCellRect(view, lastN, z).right;
+                if(!clipRect(run, r)) continue;
+                gfx->setFillColor(color);
+                gfx->bar(run.left, run.top, run.right, run.bottom);
+                bars++;
+            }
+            continue;
+        }
+        
+        for(; i < end && table.nuclide[i].n <= nMax; i++) {
+            const Nuclide& nuclide = table.nuclide[i];
+            Rect cellRect = chartCellRect(view, nuclide.n, nuclide.z);
+            Rect fill = { cellRect.left, cellRect.top + 1, cellRect.right - 1, cellRect.bottom };
+            if(!clipRect(fill, r)) continue;
+            gfx->setFillColor(decayColor(nuclide.decay));
+            gfx->bar(fill.left, fill.top, fill.right, fill.bottom);
+            bars++;
+            
+            // Text can't be clipped, so only cells wholly in the view get it
+            if(cell >= CHART_SYMBOL_CELL && insideRect(cellRect, view.area)) drawCellText(gfx, cellRect, cell, nuclide);
+        }
+    }
+    
+    outlineCell(gfx, view, table, view.hovered, COLOR_WHITE);
+    outlineCell(gfx, view, table, view.selected, COLOR_YELLOW);
+    return bars;
+}
+
+void drawDecayLegend(RenderBackend* gfx, int x, int y) {
+    const int boxW = 15;
+    const int spacing = 25;
+    
+    gfx->setTextStyle(FONT_SMALL, 5);
+    gfx->setColor(COLOR_WHITE);
+    gfx->text(x, y - 30, "Main decay mode:");
+    for(int mode = 0; mode < DECAY_MODE_COUNT; mode++) {
+        gfx->setFillColor(DECAY_COLORS[mode]);
+        gfx->bar(x, y + mode * spacing, x + boxW, y + boxW + mode * spacing);
+        gfx->setColor(COLOR_WHITE);
+        gfx->text(x + boxW + 5, y + mode * spacing, decayModeName(mode));
+    }
+}
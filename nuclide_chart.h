@@ -0,0 +1,68 @@
+#ifndef NUCLIDE_CHART_H
+#define NUCLIDE_CHART_H
+
+#include "render_backend.h"
+#include "nuclide_data.h"
+
+// Chart of the nuclides: one cell per nuclide, neutrons across and protons
+// up, colored by main decay mode. The chart is some 30 times the cells of
+// the periodic table and mostly off screen, so nothing is drawn by walking
+// every nuclide. The clip rectangle is turned into a range of Z rows and N
+// columns, and each row's run in the table (nuclide_data.h) is entered by
+// binary search at the first visible N. A frame's cost follows what is on
+// screen, not the size of the data.
+//
+// Detail follows the cell size. Small cells draw no text, and neighbours
+// in a row with the same color are merged into one bar. Medium cells are
+// separate bars with the symbol. Large cells add the half-life and the
+// abundance.
+
+const int CHART_ZOOM_LEVELS = 5;
+const int CHART_CELL_SIZES[CHART_ZOOM_LEVELS] = { 3, 6, 12, 24, 48 };
+
+// Detail thresholds, in pixels per cell
+const int CHART_GAP_CELL = 12;    // cells get a one pixel gap and stop merging
+const int CHART_SYMBOL_CELL = 24;  // symbol and mass number
+const int CHART_DETAIL_CELL = 48;  // half-life and abundance too
+
+struct ChartView {
+    Rect area;     // screen rectangle the cells are drawn in
+    int zoom;      // index into CHART_CELL_SIZES
+    int scrollX;   // chart pixels scrolled right; N = 0 starts at 0
+    int scrollY;   // chart pixels scrolled up; Z = 0 starts at 0
+    int hovered;   // nuclide index, or -1
+    int selected;  // nuclide index, or -1
+};
+
+int chartCellSize(const ChartView& view);
+
+// Function to give the screen rectangle of the cell for (n, z)
+Rect chartCellRect(const ChartView& view, int n, int z);
+
+// Function to find the nuclide drawn at a screen point; -1 if none
+int chartNuclideAt(const ChartView& view, const NuclideTable& table, int x, int y);
+
+// Function to scroll by a number of pixels, kept within the chart
+void panChart(ChartView& view, const NuclideTable& table, int dx, int dy);
+
+// Function to change the zoom level by steps, keeping the chart point under
+// (x, y) where it is
+void zoomChart(ChartView& view, const NuclideTable& table, int steps, int x, int y);
+
+// Function to scroll so the cell for (n, z) is in the middle of the area
+void centerChart(ChartView& view, const NuclideTable& table, int n, int z);
+
+int decayColor(int mode);
+
+// Function to draw one cell at its place in the view, with no culling
+void drawNuclideCell(RenderBackend* gfx, const ChartView& view, const Nuclide& nuclide);
+
+// Function to draw the cells that overlap clip (and the view area) on a
+// cleared background, hovered and selected cells outlined. Returns the
+// number of bars drawn.
+int drawNuclideChart(RenderBackend* gfx, const ChartView& view, const NuclideTable& table, const Rect& clip);
+
+// Function to draw the decay-mode color key in a column starting at (x, y)
+void drawDecayLegend(RenderBackend* gfx, int x, int y);
+
+#endif
@@ -0,0 +1,402 @@
+#include "nuclide_data.h"
+#include "mapped_file.h"
+#include "timing.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+using namespace std;
+
+enum NuclideColumn {
+    NUCLIDE_IGNORED,
+    NUCLIDE_SYMBOL,
+    NUCLIDE_MASS_NUMBER,
+    NUCLIDE_HALF_LIFE,
+    NUCLIDE_ABUNDANCE,
+    NUCLIDE_DECAY
+};
+
+struct NuclideColumnName {
+    const char* name;
+    int column;
+};
+
+const NuclideColumnName NUCLIDE_COLUMN_NAMES[] = {
+    { "symbol", NUCLIDE_SYMBOL },
+    { "a", NUCLIDE_MASS_NUMBER },
+    { "mass_number", NUCLIDE_MASS_NUMBER },
+    { "half_life", NUCLIDE_HALF_LIFE },
+    { "halflife", NUCLIDE_HALF_LIFE },
+    { "abundance", NUCLIDE_ABUNDANCE },
+    { "decay", NUCLIDE_DECAY }
+};
+
+const int MAX_NUCLIDE_COLUMNS = 8;
+const double SECONDS_PER_YEAR = 365.25 * 86400;
+
+struct TimeUnit {
+    const char* name;
+    double seconds;
+};
+
+// Largest first, so formatHalfLife can take the first that fits
+const TimeUnit TIME_UNITS[] = {
+    { "gy", 1e9 * SECONDS_PER_YEAR },
+    { "my", 1e6 * SECONDS_PER_YEAR },
+    { "ky", 1e3 * SECONDS_PER_YEAR },
+    { "y", SECONDS_PER_YEAR },
+    { "d", 86400 },
+    { "h", 3600 },
+    { "m", 60 },
+    { "min", 60 },
+    { "s", 1 },
+    { "ms", 1e-3 },
+    { "us", 1e-6 },
+    { "ns", 1e-9 }
+};
+
+const char* const TIME_UNIT_LABELS[] = { "Gy", "My", "ky", "y", "d", "h", "min", "min", "s", "ms", "us", "ns" };
+
+struct DecayName {
+    const char* name;
+    int mode;
+};
+
+const DecayName DECAY_NAMES[] = {
+    { "b-", DECAY_BETA_MINUS },
+    { "b+", DECAY_BETA_PLUS },
+    { "ec", DECAY_BETA_PLUS },
+    { "a", DECAY_ALPHA },
+    { "sf", DECAY_FISSION },
+    { "p", DECAY_PROTON },
+    { "n", DECAY_NEUTRON },
+    { "it", DECAY_ISOMERIC }
+};
+
+const char* const DECAY_MODE_NAMES[DECAY_MODE_COUNT] = {
+    "stable", "beta-", "beta+/EC", "alpha", "fission", "proton", "neutron", "isomeric", "unknown"
+};
+
+const char* decayModeName(int mode) {
+    return mode >= 0 && mode < DECAY_MODE_COUNT ? DECAY_MODE_NAMES[mode] : "?";
+}
+
+// Function to parse "5700 y", "1.2e9y" or "stable" into seconds
+static bool parseHalfLife(const Span& field, float& out) {
+    if(spanEquals(field, "stable")) {
+        out = INFINITY;
+        return true;
+    }
+    Span unit = { field.end, field.end };
+    while(unit.begin > field.begin && isalpha((unsigned char)unit.begin[-1])) unit.begin--;
+    Span number = { field.begin, unit.begin };
+    while(number.end > number.begin && isBlank(number.end[-1])) number.end--;
+    
+    double value;
+    if(!parseNumber(number, value) || value <= 0) return false;
+    for(const TimeUnit& u : TIME_UNITS) {
+        if(spanEquals(unit, u.name)) {
+            out = (float)(value * u.seconds);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to parse decay modes separated by blanks, ';' or '/'. The first
+// is the main one.
+static bool parseDecay(const Span& field, Nuclide& nuclide) {
+    const char* p = field.begin;
+    while(p < field.end) {
+        while(p < field.end && (isBlank(*p) || *p == ';' || *p == '/')) p++;
+        Span token = { p, p };
+        while(p < field.end && !isBlank(*p) && *p != ';' && *p != '/') p++;
+        token.end = p;
+        if(token.begin == token.end) break;
+        
+        int mode = -1;
+        for(const DecayName& name : DECAY_NAMES) {
+            if(spanEquals(token, name.name)) mode = name.mode;
+        }
+        if(mode < 0) return false;
+        if(nuclide.modes == 0) nuclide.decay = (unsigned char)mode;
+        nuclide.modes |= (unsigned char)(1 << (mode - 1));
+    }
+    return true;
+}
+
+void parseNuclideData(const char* data, size_t size, NuclideTable& table, DataLoadReport& report) {
+    const char* p = data;
+    const char* end = data + size;
+    int columnKind[MAX_NUCLIDE_COLUMNS];
+    int columnCount = 0;
+    int line = 0;
+    
+    while(p < end) {
+        line++;
+        const char* lineStart = p;
+        while(p < end && isBlank(*p)) p++;
+        if(p == end || *p == '\n' || *p == '#') {
+            while(p < end && *p != '\n') p++;
+            if(p < end) p++;
+            continue;
+        }
+        p = lineStart;
+        
+        if(columnCount == 0) {
+            bool hasSymbol = false, hasMass = false;
+            while(true) {
+                Span field = nextField(p, end);
+                if(columnCount == MAX_NUCLIDE_COLUMNS) {
+                    reportDataError(report, line, "too many columns");
+                    return;
+                }
+                int kind = NUCLIDE_IGNORED;
+                for(const NuclideColumnName& name : NUCLIDE_COLUMN_NAMES) {
+                    if(spanEquals(field, name.name)) kind = name.column;
+                }
+                hasSymbol |= kind == NUCLIDE_SYMBOL;
+                hasMass |= kind == NUCLIDE_MASS_NUMBER;
+                columnKind[columnCount++] = kind;
+                if(p == end || *p == '\n') break;
+                p++;
+            }
+            if(p < end) p++;
+            if(!hasSymbol || !hasMass) {
+                reportDataError(report, line, "header needs symbol and a columns");
+                return;
+            }
+            continue;
+        }
+        
+        Nuclide nuclide = { 0, 0, DECAY_UNKNOWN, 0, NAN, 0 };
+        int element = -1;
+        double massNumber = -1;
+        bool bad = false;
+        int column = 0;
+        while(true) {
+            Span field = nextField(p, end);
+            int kind = column < columnCount ? columnKind[column] : NUCLIDE_IGNORED;
+            if(field.begin != field.end && !bad) {
+                double value;
+                switch(kind) {
+                    case NUCLIDE_SYMBOL:
+                        element = symbolIndex(field);
+                        if(element < 0) {
+                            reportDataError(report, line, "unknown symbol");
+                            bad = true;
+                        }
+                        break;
+                    case NUCLIDE_MASS_NUMBER:
+                        if(!parseNumber(field, massNumber) || massNumber != floor(massNumber)) {
+                            reportDataError(report, line, "mass number is not a whole number");
+                            bad = true;
+                        }
+                        break;
+                    case NUCLIDE_HALF_LIFE:
+                        if(!parseHalfLife(field, nuclide.halfLife)) {
+                            reportDataError(report, line, "half-life needs a number and unit");
+                            bad = true;
+                        }
+                        break;
+                    case NUCLIDE_ABUNDANCE:
+                        if(parseNumber(field, value)) nuclide.abundance = (float)value;
+                        else reportDataError(report, line, "abundance is not a number");
+                        break;
+                    case NUCLIDE_DECAY:
+                        if(!parseDecay(field, nuclide)) {
+                            reportDataError(report, line, "unknown decay mode");
+                            bad = true;
+                        }
+                        break;
+                }
+            }
+            column++;
+            if(p == end || *p == '\n') break;
+            p++;
+        }
+        if(p < end) p++;
+        
+        if(bad) continue;
+        if(element < 0 || massNumber < 0) {
+            reportDataError(report, line, "row needs a symbol and mass number");
+            continue;
+        }
+        int z = element + 1;
+        int n = (int)massNumber - z;
+        if(n < 0 || n > 255) {
+            reportDataError(report, line, "mass number out of range for the element");
+            continue;
+        }
+        if(table.count == MAX_NUCLIDES) {
+            reportDataError(report, line, "too many nuclides");
+            return;
+        }
+        nuclide.z = (unsigned char)z;
+        nuclide.n = (unsigned char)n;
+        if(std::isinf(nuclide.halfLife)) {
+            nuclide.decay = DECAY_STABLE;
+            nuclide.modes = 0;
+        }
+        table.nuclide[table.count++] = nuclide;
+        report.rows++;
+        report.values++;
+    }
+}
+
+static bool nuclideBefore(const Nuclide& a, const Nuclide& b) {
+    return a.z != b.z ? a.z < b.z : a.n < b.n;
+}
+
+void indexNuclides(NuclideTable& table, DataLoadReport& report) {
+    // Stable, so the first of two rows for one nuclide is the one kept
+    stable_sort(table.nuclide, table.nuclide + table.count, nuclideBefore);
+    
+    int kept = 0;
+    for(int i = 0; i < table.count; i++) {
+        if(kept > 0 && !nuclideBefore(table.nuclide[kept - 1], table.nuclide[i])) {
+            reportDataError(report, 0, "duplicate nuclide");
+            continue;
+        }
+        table.nuclide[kept++] = table.nuclide[i];
+    }
+    table.count = kept;
+    
+    table.maxN = 0;
+    int i = 0;
+    for(int z = 0; z <= ELEMENT_COUNT + 1; z++) {
+        while(i < table.count && table.nuclide[i].z < z) i++;
+        table.first[z] = (unsigned short)i;
+    }
+    for(int k = 0; k < table.count; k++) table.maxN = max(table.maxN, (int)table.nuclide[k].n);
+}
+
+bool loadNuclideData(const char* path, NuclideTable& table, DataLoadReport& report) {
+    report = DataLoadReport();
+    long long start = timerNow();
+    table.count = 0;
+    
+    MappedFile file;
+    bool found = mapFile(path, file);
+    if(found) {
+        report.found = true;
+        parseNuclideData(file.data, file.size, table, report);
+        unmapFile(file);
+    }
+    indexNuclides(table, report);
+    
+    report.loadMs = timerMs(timerNow() - start);
+    return found;
+}
+
+static const char* nuclidePath = DEFAULT_NUCLIDE_DATA_FILE;
+static DataLoadReport nuclideReport;
+
+void setNuclideDataPath(const char* path) {
+    nuclidePath = path;
+}
+
+const char* nuclideDataPath() {
+    return nuclidePath;
+}
+
+static const NuclideTable* loadDefaultNuclides() {
+    static NuclideTable table;
+    loadNuclideData(nuclidePath, table, nuclideReport);
+    return &table;
+}
+
+const NuclideTable& nuclideTable() {
+    static const NuclideTable* table = loadDefaultNuclides();
+    return *table;
+}
+
+const DataLoadReport& nuclideDataReport() {
+    nuclideTable();  // the load happens on first use
+    return nuclideReport;
+}
+
+int printNuclideLoadReport(const DataLoadReport& report, const char* path) {
+    if(!report.found) {
+        cout << "nuclide data: " << path << " not found; the chart of the nuclides is empty" << endl;
+        return 1;
+    }
+    cout << "nuclide data: " << report.rows << " nuclides from " << path << " in " << report.loadMs << " ms" << endl;
+    if(report.errors > 0) {
+        cout << "nuclide data: " << report.errors << " problem(s), first on line "
+             << report.firstErrorLine << ": " << report.firstError << endl;
+    }
+    return report.errors;
+}
+
+int firstNuclideFrom(const NuclideTable& table, int z, int n) {
+    const Nuclide* begin = table.nuclide + table.first[z];
+    const Nuclide* end = table.nuclide + table.first[z + 1];
+    Nuclide key = { (unsigned char)z, (unsigned char)max(0, min(255, n)), 0, 0, 0, 0 };
+    const Nuclide* at = lower_bound(begin, end, key, nuclideBefore);
+    if(n > 255) at = end;
+    return (int)(at - table.nuclide);
+}
+
+int findNuclide(const NuclideTable& table, int z, int n) {
+    if(z < 1 || z > ELEMENT_COUNT || n < 0 || n > 255) return -1;
+    int i = firstNuclideFrom(table, z, n);
+    return i < table.first[z + 1] && table.nuclide[i].n == n ? i : -1;
+}
+
+void formatHalfLife(char* out, int size, float seconds) {
+    if(std::isnan(seconds)) {
+        snprintf(out, size, "unknown");
+        return;
+    }
+    if(std::isinf(seconds)) {
+        snprintf(out, size, "stable");
+        return;
+    }
+    if(seconds >= 1e3 * TIME_UNITS[0].seconds) {
+        snprintf(out, size, "%.3g y", seconds / SECONDS_PER_YEAR);
+        return;
+    }
+    const int unitCount = sizeof(TIME_UNITS) / sizeof(TIME_UNITS[0]);
+    for(int i = 0; i < unitCount; i++) {
+        if(seconds >= TIME_UNITS[i].seconds || i == unitCount - 1) {
+            snprintf(out, size, "%.3g %s", seconds / TIME_UNITS[i].seconds, TIME_UNIT_LABELS[i]);
+            return;
+        }
+    }
+}
+
+int validateNuclideData(const NuclideTable& table, bool printSummary) {
+    int problems = 0;
+    for(int z = 1; z <= ELEMENT_COUNT; z++) {
+        const Element& elem = ELEMENTS[z - 1];
+        double total = 0, massSum = 0;
+        for(int i = table.first[z]; i < table.first[z + 1]; i++) {
+            const Nuclide& nuclide = table.nuclide[i];
+            int a = nuclide.z + nuclide.n;
+            if(nuclide.abundance < 0 || nuclide.abundance > 100) {
+                cout << "nuclide " << elem.symbol << "-" << a << ": abundance " << nuclide.abundance
+                     << " is out of range" << endl;
+                problems++;
+            }
+            total += nuclide.abundance;
+            massSum += nuclide.abundance * a;
+        }
+        if(total == 0) continue;
+        
+        // The mass numbers weighted by abundance land within a fraction of
+        // the atomic weight; further off, an abundance is wrong
+        if(fabs(total - 100) > 0.5) {
+            cout << "element " << elem.symbol << ": abundances add up to " << total << "%" << endl;
+            problems++;
+        } else if(fabs(massSum / total - elem.atomicWeight) > 0.5) {
+            cout << "element " << elem.symbol << ": abundances give weight " << massSum / total
+                 << ", not " << elem.atomicWeight << endl;
+            problems++;
+        }
+    }
+    if(printSummary) cout << "validated nuclide data: " << table.count << " nuclides, " << problems << " problem(s)" << endl;
+    return problems;
+}
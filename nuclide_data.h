@@ -0,0 +1,97 @@
+#ifndef NUCLIDE_DATA_H
+#define NUCLIDE_DATA_H
+
+#include "elements.h"
+#include "element_data.h"
+
+// Nuclide (isotope) table: half-life, natural abundance and decay modes
+// for each nuclide, loaded from the nuclide data file. The file is CSV,
+// with the same rules as the element data file (element_data.h):
+//
+//   # comment
+//   symbol,a,half_life,abundance,decay
+//   C,12,stable,98.93,
+//   C,14,5700 y,,B-
+//   K,40,1.248e9 y,0.0117,B- B+
+//
+// Half-lives take a unit (ns, us, ms, s, m, h, d, y, ky, My, Gy) or are
+// "stable"; empty means unknown. Abundance is in percent. Decay modes are
+// B-, B+ (or EC), A, SF, P, N and IT, main mode first.
+//
+// Each nuclide is packed into 12 bytes, and the table is sorted by Z and
+// then N with the start of every element's run kept. The nuclides of one
+// element are contiguous and ordered by N, so a chart can find what lies
+// in a rectangle of (N, Z) by visiting only the rows in it.
+
+const char* const DEFAULT_NUCLIDE_DATA_FILE = "nuclide_data.csv";
+const int MAX_NUCLIDES = 4096;  // known ground states are about 3,300
+
+enum DecayMode {
+    DECAY_STABLE,
+    DECAY_BETA_MINUS,
+    DECAY_BETA_PLUS,      // positron emission or electron capture
+    DECAY_ALPHA,
+    DECAY_FISSION,
+    DECAY_PROTON,
+    DECAY_NEUTRON,
+    DECAY_ISOMERIC,
+    DECAY_UNKNOWN,
+    DECAY_MODE_COUNT
+};
+
+struct Nuclide {
+    unsigned char z;
+    unsigned char n;
+    unsigned char decay;   // main DecayMode
+    unsigned char modes;   // every mode seen, bit 1 << (mode - 1)
+    float halfLife;        // seconds; infinite if stable, NaN if unknown
+    float abundance;       // natural abundance, percent; 0 if none
+};
+
+static_assert(sizeof(Nuclide) == 12, "Nuclide is meant to pack into 12 bytes");
+
+struct NuclideTable {
+    int count;
+    int maxN;
+    unsigned short first[ELEMENT_COUNT + 2];  // Z's nuclides are [first[Z], first[Z + 1])
+    Nuclide nuclide[MAX_NUCLIDES];
+};
+
+// Function to parse data already in memory into the table
+void parseNuclideData(const char* data, size_t size, NuclideTable& table, DataLoadReport& report);
+
+// Function to map a data file and parse it into the table. Returns false if
+// the file could not be opened.
+bool loadNuclideData(const char* path, NuclideTable& table, DataLoadReport& report);
+
+// Function to sort the table and rebuild the per-element runs after
+// nuclides were added to it directly
+void indexNuclides(NuclideTable& table, DataLoadReport& report);
+
+// The file nuclideTable() loads on first use; set it before then
+void setNuclideDataPath(const char* path);
+const char* nuclideDataPath();
+
+const NuclideTable& nuclideTable();
+const DataLoadReport& nuclideDataReport();
+
+// Function to print the report; returns the number of problems in it
+int printNuclideLoadReport(const DataLoadReport& report, const char* path);
+
+// Function to find the nuclide with Z protons and N neutrons; -1 if none
+int findNuclide(const NuclideTable& table, int z, int n);
+
+// Function to find the first nuclide of element Z with at least N neutrons;
+// returns the end of Z's run if there is none
+int firstNuclideFrom(const NuclideTable& table, int z, int n);
+
+const char* decayModeName(int mode);
+
+// Function to format a half-life in a readable unit: "5.70 ky", "stable"
+void formatHalfLife(char* out, int size, float seconds);
+
+// Function to check the table: abundances per element sum to 100, stable
+// nuclides have no half-life. Prints each problem and returns the count.
+int validateNuclideData(const NuclideTable& table, bool printSummary = true);
+
+#endif
@@ -0,0 +1,409 @@
+#include "query_stream.h"
+#include "element_columns.h"
+#include "element_search.h"
+#include "element_filter.h"
+#include "chemical_formula.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cerrno>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const int INPUT_BLOCK = 256 * 1024;
+const int OUTPUT_BLOCK = 64 * 1024;
+const int MAX_QUERY_TEXT = 1024;  // longer queries are answered with an error
+const int MAX_RECORD = 512;       // one element's record, without the query
+const int MAX_PREFIX = MAX_QUERY_TEXT * 6 + 32;  // the query field, escaped
+const int CSV_ELEMENT_FIELDS = 13;
+
+const char* const CSV_HEADER = "query,kind,number,symbol,name,block,period,group,weight,radius,"
+                               "electronegativity,ionization,density,melting,boiling,molar_mass,charge,error\n";
+
+// Keys for the property columns, as in the data file header
+const char* const PROPERTY_KEYS[PROP_COUNT] = {
+    "weight", "radius", "electronegativity", "ionization", "density", "melting", "boiling"
+};
+
+// ---------------------------------------------------------------------------
+// Output buffer
+// ---------------------------------------------------------------------------
+
+struct OutputBuffer {
+    FILE* file;
+    size_t used;
+    long long written;
+    char data[OUTPUT_BLOCK];
+};
+
+static void flushOutput(OutputBuffer& out) {
+    if(out.used > 0) fwrite(out.data, 1, out.used, out.file);
+    out.written += (long long)out.used;
+    out.used = 0;
+}
+
+static void put(OutputBuffer& out, const char* text, size_t length) {
+    if(out.used + length > sizeof(out.data)) {
+        flushOutput(out);
+        if(length > sizeof(out.data)) {
+            fwrite(text, 1, length, out.file);
+            out.written += (long long)length;
+            return;
+        }
+    }
+    memcpy(out.data + out.used, text, length);
+    out.used += length;
+}
+
+static void put(OutputBuffer& out, const char* text) {
+    put(out, text, strlen(text));
+}
+
+static void putChar(OutputBuffer& out, char c) {
+    if(out.used == sizeof(out.data)) flushOutput(out);
+    out.data[out.used++] = c;
+}
+
+// Function to write text as the inside of a JSON string
+static void putJsonString(OutputBuffer& out, const char* text, size_t length) {
+    const char* run = text;
+    const char* end = text + length;
+    for(const char* p = text; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if(c >= 0x20 && c != '"' && c != '\\') continue;
+        
+        put(out, run, (size_t)(p - run));
+        char escape[8];
+        if(c == '"' || c == '\\') snprintf(escape, sizeof(escape), "\\%c", c);
+        else snprintf(escape, sizeof(escape), "\\u%04x", c);
+        put(out, escape);
+        run = p + 1;
+    }
+    put(out, run, (size_t)(end - run));
+}
+
+// Function to write a CSV field, quoted only if it has to be
+static void putCsvField(OutputBuffer& out, const char* text, size_t length) {
+    bool quote = false;
+    for(size_t i = 0; i < length && !quote; i++) {
+        quote = text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+    }
+    if(!quote) {
+        put(out, text, length);
+        return;
+    }
+    putChar(out, '"');
+    for(size_t i = 0; i < length; i++) {
+        if(text[i] == '"') putChar(out, '"');
+        putChar(out, text[i]);
+    }
+    putChar(out, '"');
+}
+
+// ---------------------------------------------------------------------------
+// Records
+// ---------------------------------------------------------------------------
+
+// Each element's record after the query field, formatted once per run
+struct RecordCache {
+    char text[ELEMENT_COUNT][MAX_RECORD];
+    int length[ELEMENT_COUNT];
+};
+
+int formatElementJson(char* out, int size, const ElementColumns& columns, int index) {
+    const Element& elem = ELEMENTS[index];
+    int length = snprintf(out, size, "\"number\":%d,\"symbol\":\"%s\",\"name\":\"%s\",\"block\":\"%s\","
+                          "\"period\":%d,\"group\":%d", elem.atomicNumber, elem.symbol, elem.name, elem.block,
+                          elem.period, elem.group);
+    for(int p = 0; p < PROP_COUNT; p++) {
+        double value = propertyColumn(columns, p)[index];
+        if(std::isnan(value)) length += snprintf(out + length, size - length, ",\"%s\":null", PROPERTY_KEYS[p]);
+        else length += snprintf(out + length, size - length, ",\"%s\":%.6g", PROPERTY_KEYS[p], value);
+    }
+    return length;
+}
+
+int formatMassJson(char* out, const FormulaResult& result) {
+    int length = sprintf(out, "\"molar_mass\":");
+    length += formatDecimal(out + length, result.molarMass, 4);
+    length += sprintf(out + length, ",\"charge\":%d,\"composition\":[", result.charge);
+    for(int i = 0; i < result.elementCount; i++) {
+        length += sprintf(out + length, "%s{\"symbol\":\"%s\",\"atoms\":", i > 0 ? "," : "",
+                          ELEMENTS[result.element[i]].symbol);
+        length += formatDecimal(out + length, (double)result.atoms[i], 0);
+        length += sprintf(out + length, ",\"percent\":");
+        length += formatDecimal(out + length, result.massPercent[i], 3);
+        out[length++] = '}';
+    }
+    out[length++] = ']';
+    out[length] = '\0';
+    return length;
+}
+
+static void buildRecordCache(const ElementColumns& columns, int format, RecordCache& cache) {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        const Element& elem = ELEMENTS[i];
+        char* text = cache.text[i];
+        int length;
+        if(format == FORMAT_JSON_LINES) {
+            length = formatElementJson(text, MAX_RECORD, columns, i);
+            length += snprintf(text + length, MAX_RECORD - length, "}\n");
+        } else {
+            length = snprintf(text, MAX_RECORD, ",element,%d,%s,%s,%s,%d,%d", elem.atomicNumber, elem.symbol,
+                              elem.name, elem.block, elem.period, elem.group);
+            for(int p = 0; p < PROP_COUNT; p++) {
+                double value = propertyColumn(columns, p)[i];
+                if(std::isnan(value)) length += snprintf(text + length, MAX_RECORD - length, ",");
+                else length += snprintf(text + length, MAX_RECORD - length, ",%.6g", value);
+            }
+            length += snprintf(text + length, MAX_RECORD - length, ",,,\n");
+        }
+        cache.length[i] = length;
+    }
+}
+
+struct QueryContext {
+    OutputBuffer* out;
+    int format;
+    const ElementColumns* columns;
+    const RecordCache* cache;
+    QueryStreamReport* report;
+    char prefix[MAX_PREFIX];  // the current query's field, escaped once for all its records
+    size_t prefixLength;
+};
+
+// Function to escape the query (at most MAX_QUERY_TEXT bytes) into the
+// record prefix
+static void setQuery(QueryContext& context, const char* query, size_t length) {
+    char* p = context.prefix;
+    if(context.format == FORMAT_JSON_LINES) {
+        memcpy(p, "{\"query\":\"", 10);
+        p += 10;
+        for(size_t i = 0; i < length; i++) {
+            unsigned char c = (unsigned char)query[i];
+            if(c == '"' || c == '\\') {
+                *p++ = '\\';
+                *p++ = (char)c;
+            } else if(c < 0x20) {
+                p += sprintf(p, "\\u%04x", c);
+            } else {
+                *p++ = (char)c;
+            }
+        }
+        *p++ = '"';
+        *p++ = ',';
+    } else {
+        bool quote = false;
+        for(size_t i = 0; i < length && !quote; i++) {
+            quote = query[i] == ',' || query[i] == '"' || query[i] == '\n' || query[i] == '\r';
+        }
+        if(quote) *p++ = '"';
+        for(size_t i = 0; i < length; i++) {
+            if(quote && query[i] == '"') *p++ = '"';
+            *p++ = query[i];
+        }
+        if(quote) *p++ = '"';
+    }
+    context.prefixLength = (size_t)(p - context.prefix);
+}
+
+static void startRecord(QueryContext& context) {
+    context.report->records++;
+    put(*context.out, context.prefix, context.prefixLength);
+}
+
+static void writeElement(QueryContext& context, int index) {
+    startRecord(context);
+    put(*context.out, context.cache->text[index], (size_t)context.cache->length[index]);
+}
+
+static void writeError(QueryContext& context, const char* message) {
+    OutputBuffer& out = *context.out;
+    context.report->errors++;
+    startRecord(context);
+    if(context.format == FORMAT_JSON_LINES) {
+        put(out, "\"error\":\"");
+        putJsonString(out, message, strlen(message));
+        put(out, "\"}\n");
+    } else {
+        put(out, ",error");
+        for(int i = 0; i < CSV_ELEMENT_FIELDS + 2; i++) putChar(out, ',');
+        putChar(out, ',');
+        putCsvField(out, message, strlen(message));
+        putChar(out, '\n');
+    }
+}
+
+static void writeMass(QueryContext& context, const FormulaResult& result) {
+    OutputBuffer& out = *context.out;
+    startRecord(context);
+    char buffer[MAX_MASS_JSON];
+    int length;
+    if(context.format == FORMAT_JSON_LINES) {
+        length = formatMassJson(buffer, result);
+        length += sprintf(buffer + length, "}\n");
+        put(out, buffer, (size_t)length);
+    } else {
+        put(out, ",mass");
+        for(int i = 0; i < CSV_ELEMENT_FIELDS; i++) putChar(out, ',');
+        length = sprintf(buffer, ",");
+        length += formatDecimal(buffer + length, result.molarMass, 4);
+        length += sprintf(buffer + length, ",%d,\n", result.charge);
+        put(out, buffer, (size_t)length);
+    }
+}
+
+static bool wordEquals(const char* word, size_t length, const char* text) {
+    return strlen(text) == length && memcmp(word, text, length) == 0;
+}
+
+// Function to answer one input line
+static void answerQuery(QueryContext& context, const char* line, size_t length) {
+    const char* first = line;
+    const char* last = line + length;
+    while(first < last && (*first == ' ' || *first == '\t')) first++;
+    while(last > first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+    if(first == last || *first == '#') return;
+
+    context.report->queries++;
+    size_t queryLength = (size_t)(last - first);
+    if(queryLength >= (size_t)MAX_QUERY_TEXT) {
+        setQuery(context, first, MAX_QUERY_TEXT);
+        writeError(context, "query too long");
+        return;
+    }
+    setQuery(context, first, queryLength);
+
+    // An optional command word, then its argument; a bare query is "get"
+    const char* space = first;
+    while(space < last && *space != ' ' && *space != '\t') space++;
+    const char* argument = first;
+    enum { QUERY_GET, QUERY_FILTER, QUERY_MASS } kind = QUERY_GET;
+    size_t wordLength = (size_t)(space - first);
+    if(wordEquals(first, wordLength, "get")) kind = QUERY_GET;
+    else if(wordEquals(first, wordLength, "filter")) kind = QUERY_FILTER;
+    else if(wordEquals(first, wordLength, "mass")) kind = QUERY_MASS;
+    else space = first;
+    if(space != first) {
+        argument = space;
+        while(argument < last && (*argument == ' ' || *argument == '\t')) argument++;
+    }
+
+    size_t argumentLength = (size_t)(last - argument);
+    char text[MAX_QUERY_TEXT];
+    memcpy(text, argument, argumentLength);
+    text[argumentLength] = '\0';
+
+    if(kind == QUERY_GET) {
+        int index = argumentLength > 0 ? bestSearchMatch(text) : -1;
+        if(index < 0) writeError(context, "no single element matches");
+        else writeElement(context, index);
+    } else if(kind == QUERY_FILTER) {
+        ElementFilter filter;
+        if(!parseFilter(text, filter)) {
+            writeError(context, filter.error);
+            return;
+        }
+        ElementMask mask = evaluateFilter(filter, *context.columns);
+        for(int i = 0; i < ELEMENT_COUNT; i++) {
+            if(maskTest(mask, i)) writeElement(context, i);
+        }
+    } else {
+        FormulaResult result;
+        if(parseFormula(text, argumentLength, *context.columns, result)) {
+            writeMass(context, result);
+        } else {
+            char message[80];
+            snprintf(message, sizeof(message), "%s at column %d", result.error, result.errorPosition + 1);
+            writeError(context, message);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Input
+// ---------------------------------------------------------------------------
+
+// Function to read whatever input is available, up to size bytes. Unlike
+// fread this returns as soon as a pipe has something, so a script that
+// writes a query and waits for the answer is not left hanging. Returns 0
+// at the end of the input.
+static long readBlock(FILE* in, char* buffer, size_t size) {
+    for(;;) {
+#ifdef _WIN32
+        long n = _read(_fileno(in), buffer, (unsigned)size);
+#else
+        long n = (long)read(fileno(in), buffer, size);
+#endif
+        if(n >= 0) return n;
+        if(errno != EINTR) return 0;
+    }
+}
+
+void runQueryStream(FILE* in, FILE* out, int format, QueryStreamReport& report) {
+    static char input[INPUT_BLOCK];
+    static OutputBuffer output;
+    static RecordCache cache;
+    memset(&report, 0, sizeof(report));
+    long long start = timerNow();
+
+    const ElementColumns& columns = elementColumns();
+    buildRecordCache(columns, format, cache);
+    output.file = out;
+    output.used = 0;
+    output.written = 0;
+    QueryContext context = { &output, format, &columns, &cache, &report, { 0 }, 0 };
+    if(format == FORMAT_CSV) put(output, CSV_HEADER);
+
+    size_t have = 0;
+    bool skipping = false;  // the rest of a line too long for the buffer
+    for(;;) {
+        // Whatever is answered goes out before waiting for more input
+        flushOutput(output);
+        fflush(out);
+        long n = readBlock(in, input + have, sizeof(input) - have);
+        report.bytesIn += n;
+        have += (size_t)n;
+
+        size_t lineStart = 0;
+        for(;;) {
+            const char* newline = (const char*)memchr(input + lineStart, '\n', have - lineStart);
+            if(newline == NULL) break;
+            if(!skipping) answerQuery(context, input + lineStart, (size_t)(newline - input) - lineStart);
+            skipping = false;
+            lineStart = (size_t)(newline - input) + 1;
+        }
+
+        if(n == 0) {
+            if(lineStart < have && !skipping) answerQuery(context, input + lineStart, have - lineStart);
+            break;
+        }
+        memmove(input, input + lineStart, have - lineStart);
+        have -= lineStart;
+        if(have == sizeof(input)) {
+            if(!skipping) {
+                report.queries++;
+                setQuery(context, input, MAX_QUERY_TEXT);
+                writeError(context, "query too long");
+            }
+            skipping = true;
+            have = 0;
+        }
+    }
+
+    flushOutput(output);
+    fflush(out);
+    report.bytesOut = output.written;
+    report.ms = timerMs(timerNow() - start);
+}
+
+void printQueryStreamReport(const QueryStreamReport& report) {
+    double seconds = report.ms / 1000.0;
+    fprintf(stderr, "%lld queries, %lld records, %lld errors in %.1f ms (%.2f M queries/s, %.1f MB/s in, %.1f MB/s out)\n",
+            report.queries, report.records, report.errors, report.ms, report.queries / seconds / 1e6,
+            report.bytesIn / seconds / 1e6, report.bytesOut / seconds / 1e6);
+}
@@ -0,0 +1,55 @@
+#ifndef QUERY_STREAM_H
+#define QUERY_STREAM_H
+
+#include "element_columns.h"
+#include "chemical_formula.h"
+#include <stdio.h>
+
+// Non-graphical query mode: reads queries one per line and streams one
+// result record per line back, as JSON Lines or CSV. Queries:
+//
+//   Fe   26   iron   get Fe         one element, by symbol, number or name
+//   filter block=d & weight>50      every matching element, one record each
+//   mass Ca(OH)2·2H2O               molar mass and composition
+//
+// Blank lines and # comments are skipped. A query that fails produces an
+// error record, and the stream carries on.
+//
+// Input is read in large blocks and split into lines in place; output
+// goes through one fixed buffer that is written out whenever it fills.
+// Element records are the same for every query, so each element's record
+// is formatted once per run and copied after that. Nothing is allocated
+// per query.
+
+enum QueryFormat {
+    FORMAT_JSON_LINES,
+    FORMAT_CSV
+};
+
+struct QueryStreamReport {
+    long long queries;
+    long long records;   // result lines written, errors included
+    long long errors;
+    long long bytesIn;
+    long long bytesOut;
+    double ms;
+};
+
+// Function to answer every query read from in, writing records to out.
+// CSV output starts with a header line.
+void runQueryStream(FILE* in, FILE* out, int format, QueryStreamReport& report);
+
+// Function to print the report, to stderr so it stays out of the stream
+void printQueryStreamReport(const QueryStreamReport& report);
+
+// The JSON both this and the HTTP server (element_server.h) answer with.
+// formatElementJson writes an element's fields, "number":26,... without
+// the braces, and returns the length. formatMassJson does the same for a
+// formula: "molar_mass":...,"charge":...,"composition":[...]. Its output
+// fits in MAX_MASS_JSON.
+const int MAX_MASS_JSON = 128 + MAX_FORMULA_ELEMENTS * 64;
+
+int formatElementJson(char* out, int size, const ElementColumns& columns, int index);
+int formatMassJson(char* out, const FormulaResult& result);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+// Drawing and input surface the table view renders through. The WinBGIm
+// window implements it for the desktop build; NullBackend implements it
+// without a display so the view can be run and benchmarked headless.
+// Calls mirror the BGI ones they replace: rectangles are inclusive, colors
+// are BGI palette numbers, and images are opaque buffers sized by imageSize.
+
+// Screen rectangle, inclusive on all sides like the BGI drawing calls
+struct Rect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+enum EventType {
+    EVENT_CLICK,
+    EVENT_MOUSEMOVE,
+    EVENT_KEY,
+    EVENT_WHEEL,  // key holds the notches turned, positive away from the user
+    EVENT_WAKE  // posted by wake(); carries nothing
+};
+
+struct InputEvent {
+    int type;
+    int x;
+    int y;
+    int key;
+    int modifiers;    // MOD_ flags held when the event happened
+    long long stamp;  // timerNow() when the event was queued
+};
+
+const int MOD_SHIFT = 1;
+
+const int WAIT_FOREVER = -1;
+const int KEY_BACKSPACE = 8;
+const int KEY_ENTER = 13;
+const int KEY_ESCAPE = 27;
+
+// Keys with no character, past the range of WM_CHAR codes
+const int KEY_LEFT = 256;
+const int KEY_UP = 257;
+const int KEY_RIGHT = 258;
+const int KEY_DOWN = 259;
+
+enum FontName {
+    FONT_SMALL,
+    FONT_GOTHIC
+};
+
+enum LineWidth {
+    LINE_NORMAL,
+    LINE_THICK
+};
+
+enum ImageOp {
+    IMAGE_COPY,
+    IMAGE_XOR,
+    IMAGE_OR,
+    IMAGE_AND
+};
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+    
+    virtual int maxX() = 0;
+    virtual int maxY() = 0;
+    
+    // Color value for an RGB triple, usable wherever a palette color is
+    virtual int rgbColor(int red, int green, int blue) = 0;
+    
+    virtual void setColor(int color) = 0;
+    virtual void setBackgroundColor(int color) = 0;
+    virtual void setFillColor(int color) = 0;
+    virtual void setLineWidth(int width) = 0;
+    virtual void setTextStyle(int font, int size) = 0;
+    
+    virtual void rectangle(int left, int top, int right, int bottom) = 0;
+    virtual void bar(int left, int top, int right, int bottom) = 0;
+    virtual void circle(int x, int y, int radius) = 0;
+    virtual void fillCircle(int x, int y, int radius) = 0;  // fill color, outlined in the draw color
+    virtual void text(int x, int y, const char* str) = 0;
+    
+    // Drawing goes to the active page; the visual page is the one on screen
+    virtual void setActivePage(int page) = 0;
+    virtual void setVisualPage(int page) = 0;
+    
+    virtual unsigned imageSize(const Rect& r) = 0;
+    virtual void getImage(const Rect& r, void* buffer) = 0;
+    virtual void putImage(int x, int y, const void* buffer, int op) = 0;
+    
+    // Blocks until the next input event or until timeoutMs elapses
+    // (WAIT_FOREVER to block indefinitely). Returns false on timeout.
+    virtual bool waitForEvent(InputEvent& ev, int timeoutMs) = 0;
+    
+    // Queues an EVENT_WAKE so waitForEvent returns. The one call that is
+    // safe from any thread; background work uses it to get the UI thread
+    // to pick up its results.
+    virtual void wake() = 0;
+};
+
+#endif
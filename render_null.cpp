@@ -0,0 +1,125 @@
+#include "render_null.h"
+#include "timing.h"
+#include <cstring>
+#include <chrono>
+
+// Images only record their size; that is all putImage needs to count pixels
+struct NullImage {
+    int width;
+    int height;
+};
+
+NullBackend::NullBackend(int width, int height) : width(width), height(height) {
+    resetCounters();
+}
+
+void NullBackend::postEvent(int type, int x, int y, int key, int modifiers) {
+    InputEvent ev;
+    ev.type = type;
+    ev.x = x;
+    ev.y = y;
+    ev.key = key;
+    ev.modifiers = modifiers;
+    ev.stamp = timerNow();
+    
+    std::lock_guard<std::mutex> lock(eventLock);
+    events.push_back(ev);
+    eventPosted.notify_one();
+}
+
+void NullBackend::resetCounters() {
+    memset(&drawCounters, 0, sizeof(drawCounters));
+}
+
+const DrawCounters& NullBackend::counters() const {
+    return drawCounters;
+}
+
+int NullBackend::maxX() {
+    return width - 1;
+}
+
+int NullBackend::maxY() {
+    return height - 1;
+}
+
+// Same encoding as WinBGIm's COLOR(), so values never clash with the palette
+int NullBackend::rgbColor(int red, int green, int blue) {
+    return 0x04000000 | (blue << 16) | (green << 8) | red;
+}
+
+void NullBackend::setColor(int) {
+}
+
+void NullBackend::setBackgroundColor(int) {
+}
+
+void NullBackend::setFillColor(int) {
+}
+
+void NullBackend::setLineWidth(int) {
+}
+
+void NullBackend::setTextStyle(int, int) {
+    drawCounters.textStyleChanges++;
+}
+
+void NullBackend::rectangle(int, int, int, int) {
+    drawCounters.rectangles++;
+}
+
+void NullBackend::bar(int, int, int, int) {
+    drawCounters.bars++;
+}
+
+void NullBackend::circle(int, int, int) {
+    drawCounters.circles++;
+}
+
+void NullBackend::fillCircle(int, int, int) {
+    drawCounters.circles++;
+}
+
+void NullBackend::text(int, int, const char*) {
+    drawCounters.texts++;
+}
+
+void NullBackend::setActivePage(int) {
+}
+
+void NullBackend::setVisualPage(int) {
+}
+
+unsigned NullBackend::imageSize(const Rect&) {
+    return sizeof(NullImage);
+}
+
+void NullBackend::getImage(const Rect& r, void* buffer) {
+    NullImage* image = (NullImage*)buffer;
+    image->width = r.right - r.left + 1;
+    image->height = r.bottom - r.top + 1;
+    drawCounters.imageGets++;
+}
+
+void NullBackend::putImage(int, int, const void* buffer, int) {
+    const NullImage* image = (const NullImage*)buffer;
+    drawCounters.imagePuts++;
+    drawCounters.pixelsCopied += (long long)image->width * image->height;
+}
+
+// An empty queue waits out the timeout unless another thread posts;
+// WAIT_FOREVER returns at once rather than hang a headless run
+bool NullBackend::waitForEvent(InputEvent& ev, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(eventLock);
+    if(events.empty() && timeoutMs > 0) {
+        eventPosted.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !events.empty(); });
+    }
+    if(events.empty()) return false;
+    ev = events.front();
+    events.pop_front();
+    return true;
+}
+
+void NullBackend::wake() {
+    postEvent(EVENT_WAKE, 0, 0, 0);
+}
@@ -0,0 +1,69 @@
+#ifndef RENDER_NULL_H
+#define RENDER_NULL_H
+
+#include "render_backend.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Primitive-call counters, so benchmarks can report how much drawing work a
+// frame would have cost on a real display
+struct DrawCounters {
+    long long rectangles;
+    long long bars;
+    long long circles;
+    long long texts;
+    long long textStyleChanges;
+    long long imageGets;
+    long long imagePuts;
+    long long pixelsCopied;
+};
+
+// RenderBackend with no display: drawing calls are only counted, and input
+// comes from events queued with postEvent. Used to run and benchmark the
+// table view on machines without WinBGIm. postEvent and wake may be called
+// from any thread.
+class NullBackend : public RenderBackend {
+public:
+    NullBackend(int width, int height);
+    
+    void postEvent(int type, int x, int y, int key, int modifiers = 0);
+    void resetCounters();
+    const DrawCounters& counters() const;
+    
+    int maxX();
+    int maxY();
+    
+    int rgbColor(int red, int green, int blue);
+    void setColor(int color);
+    void setBackgroundColor(int color);
+    void setFillColor(int color);
+    void setLineWidth(int width);
+    void setTextStyle(int font, int size);
+    
+    void rectangle(int left, int top, int right, int bottom);
+    void bar(int left, int top, int right, int bottom);
+    void circle(int x, int y, int radius);
+    void fillCircle(int x, int y, int radius);
+    void text(int x, int y, const char* str);
+    
+    void setActivePage(int page);
+    void setVisualPage(int page);
+    
+    unsigned imageSize(const Rect& r);
+    void getImage(const Rect& r, void* buffer);
+    void putImage(int x, int y, const void* buffer, int op);
+    
+    bool waitForEvent(InputEvent& ev, int timeoutMs);
+    void wake();
+    
+private:
+    int width;
+    int height;
+    DrawCounters drawCounters;
+    std::deque<InputEvent> events;
+    std::mutex eventLock;
+    std::condition_variable eventPosted;
+};
+
+#endif
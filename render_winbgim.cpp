@@ -0,0 +1,221 @@
+#include <graphics.h>
+#pragma link<winbgim.a>
+#include "render_winbgim.h"
+#include "timing.h"
+
+// ---------------------------------------------------------------------------
+// Input events
+//
+// WinBGIm runs its window on a separate thread. Mouse handlers registered with
+// registermousehandler, and a subclassed window procedure for the keyboard,
+// push events into a small queue and signal the main thread, which sleeps in
+// waitForEvent until something arrives (or a deadline passes) instead of
+// polling ismouseclick. Consecutive mouse moves are merged into one, and so
+// are wheel turns, so a fast spin of the wheel costs one zoom, not one per
+// notch.
+// ---------------------------------------------------------------------------
+
+const int EVENT_QUEUE_SIZE = 64;
+static InputEvent eventQueue[EVENT_QUEUE_SIZE];
+static int eventHead = 0;
+static int eventCount = 0;
+static CRITICAL_SECTION eventLock;
+static HANDLE eventSignal = NULL;
+static WNDPROC originalWndProc = NULL;
+
+// Function to queue an event from the window thread and wake the main thread
+static void postInputEvent(int type, int x, int y, int key, int modifiers = 0) {
+    EnterCriticalSection(&eventLock);
+    
+    int last = (eventHead + eventCount - 1) % EVENT_QUEUE_SIZE;
+    if(type == EVENT_MOUSEMOVE && eventCount > 0 && eventQueue[last].type == EVENT_MOUSEMOVE) {
+        // Coalesce motion: only the latest position matters
+        eventQueue[last].x = x;
+        eventQueue[last].y = y;
+    } else if(type == EVENT_WHEEL && eventCount > 0 && eventQueue[last].type == EVENT_WHEEL) {
+        eventQueue[last].x = x;
+        eventQueue[last].y = y;
+        eventQueue[last].key += key;
+    } else if(eventCount < EVENT_QUEUE_SIZE) {
+        InputEvent& ev = eventQueue[(eventHead + eventCount) % EVENT_QUEUE_SIZE];
+        ev.type = type;
+        ev.x = x;
+        ev.y = y;
+        ev.key = key;
+        ev.modifiers = modifiers;
+        ev.stamp = timerNow();
+        eventCount++;
+    }
+    
+    LeaveCriticalSection(&eventLock);
+    SetEvent(eventSignal);
+}
+
+static void onLeftButtonDown(int x, int y) {
+    postInputEvent(EVENT_CLICK, x, y, 0, GetKeyState(VK_SHIFT) < 0 ? MOD_SHIFT : 0);
+}
+
+static void onMouseMove(int x, int y) {
+    postInputEvent(EVENT_MOUSEMOVE, x, y, 0);
+}
+
+// Wheel movement short of a whole notch, from mice that report finer steps
+static int wheelRemainder = 0;
+
+static void onMouseWheel(HWND hwnd, WPARAM wParam, LPARAM lParam) {
+    wheelRemainder += GET_WHEEL_DELTA_WPARAM(wParam);
+    int notches = wheelRemainder / WHEEL_DELTA;
+    if(notches == 0) return;
+    wheelRemainder -= notches * WHEEL_DELTA;
+    
+    // The position comes in screen coordinates
+    POINT point = { (short)LOWORD(lParam), (short)HIWORD(lParam) };
+    ScreenToClient(hwnd, &point);
+    postInputEvent(EVENT_WHEEL, point.x, point.y, notches);
+}
+
+// Function to map the arrow keys, which send no WM_CHAR; 0 for other keys
+static int arrowKey(WPARAM key) {
+    switch(key) {
+        case VK_LEFT: return KEY_LEFT;
+        case VK_UP: return KEY_UP;
+        case VK_RIGHT: return KEY_RIGHT;
+        case VK_DOWN: return KEY_DOWN;
+    }
+    return 0;
+}
+
+static LRESULT CALLBACK inputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if(msg == WM_CHAR) {
+        postInputEvent(EVENT_KEY, 0, 0, (int)wParam);
+        return 0;
+    }
+    if(msg == WM_KEYDOWN && arrowKey(wParam) != 0) {
+        postInputEvent(EVENT_KEY, 0, 0, arrowKey(wParam));
+        return 0;
+    }
+    if(msg == WM_MOUSEWHEEL) {
+        onMouseWheel(hwnd, wParam, lParam);
+        return 0;
+    }
+    return CallWindowProc(originalWndProc, hwnd, msg, wParam, lParam);
+}
+
+void WinBgimBackend::open(int width, int height, const char* title) {
+    initwindow(width, height, title);
+    setbkcolor(BLACK);
+    cleardevice();
+    
+    InitializeCriticalSection(&eventLock);
+    eventSignal = CreateEvent(NULL, FALSE, FALSE, NULL);
+    
+    registermousehandler(WM_LBUTTONDOWN, onLeftButtonDown);
+    registermousehandler(WM_MOUSEMOVE, onMouseMove);
+    
+    HWND window = FindWindow(NULL, title);
+    if(window != NULL) {
+        originalWndProc = (WNDPROC)SetWindowLongPtr(window, GWLP_WNDPROC, (LONG_PTR)inputWndProc);
+    }
+}
+
+void WinBgimBackend::close() {
+    closegraph();
+}
+
+bool WinBgimBackend::waitForEvent(InputEvent& ev, int timeoutMs) {
+    DWORD timeout = timeoutMs == WAIT_FOREVER ? INFINITE : (DWORD)timeoutMs;
+    while(1) {
+        EnterCriticalSection(&eventLock);
+        if(eventCount > 0) {
+            ev = eventQueue[eventHead];
+            eventHead = (eventHead + 1) % EVENT_QUEUE_SIZE;
+            eventCount--;
+            LeaveCriticalSection(&eventLock);
+            return true;
+        }
+        LeaveCriticalSection(&eventLock);
+        
+        if(WaitForSingleObject(eventSignal, timeout) == WAIT_TIMEOUT) return false;
+    }
+}
+
+void WinBgimBackend::wake() {
+    postInputEvent(EVENT_WAKE, 0, 0, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Drawing
+// ---------------------------------------------------------------------------
+
+int WinBgimBackend::maxX() {
+    return getmaxx();
+}
+
+int WinBgimBackend::maxY() {
+    return getmaxy();
+}
+
+int WinBgimBackend::rgbColor(int red, int green, int blue) {
+    return COLOR(red, green, blue);
+}
+
+void WinBgimBackend::setColor(int color) {
+    setcolor(color);
+}
+
+void WinBgimBackend::setBackgroundColor(int color) {
+    setbkcolor(color);
+}
+
+void WinBgimBackend::setFillColor(int color) {
+    setfillstyle(SOLID_FILL, color);
+}
+
+void WinBgimBackend::setLineWidth(int width) {
+    setlinestyle(SOLID_LINE, 0, width == LINE_THICK ? THICK_WIDTH : NORM_WIDTH);
+}
+
+void WinBgimBackend::setTextStyle(int font, int size) {
+    settextstyle(font == FONT_GOTHIC ? GOTHIC_FONT : SMALL_FONT, HORIZ_DIR, size);
+}
+
+void WinBgimBackend::rectangle(int left, int top, int right, int bottom) {
+    ::rectangle(left, top, right, bottom);
+}
+
+void WinBgimBackend::bar(int left, int top, int right, int bottom) {
+    ::bar(left, top, right, bottom);
+}
+
+void WinBgimBackend::circle(int x, int y, int radius) {
+    ::circle(x, y, radius);
+}
+
+void WinBgimBackend::fillCircle(int x, int y, int radius) {
+    fillellipse(x, y, radius, radius);
+}
+
+void WinBgimBackend::text(int x, int y, const char* str) {
+    outtextxy(x, y, (char*)str);
+}
+
+void WinBgimBackend::setActivePage(int page) {
+    setactivepage(page);
+}
+
+void WinBgimBackend::setVisualPage(int page) {
+    setvisualpage(page);
+}
+
+unsigned WinBgimBackend::imageSize(const Rect& r) {
+    return imagesize(r.left, r.top, r.right, r.bottom);
+}
+
+void WinBgimBackend::getImage(const Rect& r, void* buffer) {
+    getimage(r.left, r.top, r.right, r.bottom, buffer);
+}
+
+void WinBgimBackend::putImage(int x, int y, const void* buffer, int op) {
+    const int ops[] = { COPY_PUT, XOR_PUT, OR_PUT, AND_PUT };
+    putimage(x, y, (void*)buffer, ops[op]);
+}
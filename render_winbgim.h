@@ -0,0 +1,41 @@
+#ifndef RENDER_WINBGIM_H
+#define RENDER_WINBGIM_H
+
+#include "render_backend.h"
+
+// RenderBackend for a WinBGIm window. Mouse and keyboard input arrive on the
+// WinBGIm window thread and are queued for waitForEvent.
+class WinBgimBackend : public RenderBackend {
+public:
+    // Function to open the window and hook up mouse and keyboard input
+    void open(int width, int height, const char* title);
+    void close();
+    
+    int maxX();
+    int maxY();
+    
+    int rgbColor(int red, int green, int blue);
+    void setColor(int color);
+    void setBackgroundColor(int color);
+    void setFillColor(int color);
+    void setLineWidth(int width);
+    void setTextStyle(int font, int size);
+    
+    void rectangle(int left, int top, int right, int bottom);
+    void bar(int left, int top, int right, int bottom);
+    void circle(int x, int y, int radius);
+    void fillCircle(int x, int y, int radius);
+    void text(int x, int y, const char* str);
+    
+    void setActivePage(int page);
+    void setVisualPage(int page);
+    
+    unsigned imageSize(const Rect& r);
+    void getImage(const Rect& r, void* buffer);
+    void putImage(int x, int y, const void* buffer, int op);
+    
+    bool waitForEvent(InputEvent& ev, int timeoutMs);
+    void wake();
+};
+
+#endif
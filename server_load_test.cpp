@@ -0,0 +1,244 @@
+#include "server_load_test.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#ifdef __linux__
+
+const int MAX_CLIENT_THREADS = 4;
+const int HISTOGRAM_US = 100000;  // 1 us buckets up to 100 ms; anything slower lands in the last
+const int RECEIVE_BUFFER = 64 * 1024;
+const int EPOLL_BATCH = 64;
+
+const char* const LOAD_TEST_PATHS[] = {
+    "/element/Fe", "/element/26", "/element/gold", "/mass?formula=Ca(OH)2%C2%B72H2O",
+    "/element/Og", "/element/H", "/filter?q=block%3Dd%20%26%20weight%3E100", "/element/U"
+};
+const int LOAD_TEST_PATH_COUNT = sizeof(LOAD_TEST_PATHS) / sizeof(LOAD_TEST_PATHS[0]);
+
+struct ClientConnection {
+    int fd;
+    int nextPath;
+    long long sentAt;
+    int headerUsed;
+    long long bodyLeft;  // -1 while the headers are still arriving
+    int status;
+    char header[512];
+};
+
+struct ClientThread {
+    int connectionCount;
+    long long end;
+    long long requests;
+    long long errors;
+    long long maxNs;
+    unsigned* histogram;
+    ClientConnection* connections;
+    std::thread thread;
+};
+
+static bool sendRequest(ClientConnection& conn) {
+    char request[256];
+    int length = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n",
+                          LOAD_TEST_PATHS[conn.nextPath]);
+    conn.nextPath = (conn.nextPath + 1) % LOAD_TEST_PATH_COUNT;
+    conn.sentAt = timerNow();
+    return send(conn.fd, request, length, MSG_NOSIGNAL) == length;
+}
+
+// Function to record a finished response and send the next request
+static bool finishResponse(ClientThread& client, ClientConnection& conn) {
+    long long ns = timerNow() - conn.sentAt;
+    long long us = ns / 1000;
+    client.histogram[us < HISTOGRAM_US ? us : HISTOGRAM_US]++;
+    if(ns > client.maxNs) client.maxNs = ns;
+    if(conn.status == 200) client.requests++;
+    else client.errors++;
+    
+    conn.headerUsed = 0;
+    conn.bodyLeft = -1;
+    return timerNow() >= client.end || sendRequest(conn);
+}
+
+// Function to feed received bytes through the response parser
+static bool consume(ClientThread& client, ClientConnection& conn, const char* data, int length) {
+    while(length > 0) {
+        if(conn.bodyLeft < 0) {
+            if(conn.headerUsed == (int)sizeof(conn.header) - 1) return false;  // leave room for the terminator
+            conn.header[conn.headerUsed++] = *data++;
+            length--;
+            if(conn.headerUsed < 4 || memcmp(conn.header + conn.headerUsed - 4, "\r\n\r\n", 4) != 0) continue;
+            
+            conn.header[conn.headerUsed] = '\0';
+            conn.status = conn.headerUsed > 12 ? atoi(conn.header + 9) : 0;
+            const char* contentLength = strstr(conn.header, "Content-Length: ");
+            if(contentLength == NULL) return false;
+            conn.bodyLeft = atoll(contentLength + 16);
+        } else {
+            int take = conn.bodyLeft < length ? (int)conn.bodyLeft : length;
+            conn.bodyLeft -= take;
+            data += take;
+            length -= take;
+        }
+        if(conn.bodyLeft == 0 && !finishResponse(client, conn)) return false;
+    }
+    return true;
+}
+
+static void runClient(ClientThread* client) {
+    static thread_local char buffer[RECEIVE_BUFFER];
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    for(int i = 0; i < client->connectionCount; i++) {
+        ClientConnection& conn = client->connections[i];
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = &conn;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, conn.fd, &event);
+        if(!sendRequest(conn)) client->errors++;
+    }
+    
+    struct epoll_event events[EPOLL_BATCH];
+    while(timerNow() < client->end) {
+        int count = epoll_wait(epoll, events, EPOLL_BATCH, 10);
+        for(int e = 0; e < count; e++) {
+            ClientConnection& conn = *(ClientConnection*)events[e].data.ptr;
+            for(;;) {
+                ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+                if(n > 0 && consume(*client, conn, buffer, (int)n)) continue;
+                if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                
+                // Closed or broken: count it and stop watching this one
+                client->errors++;
+                epoll_ctl(epoll, EPOLL_CTL_DEL, conn.fd, NULL);
+                break;
+            }
+        }
+    }
+    close(epoll);
+}
+
+static int connectLoopback(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0) return -1;
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Function to find the latency below which fraction of the requests fell
+static double histogramPercentile(const unsigned* histogram, long long total, double fraction) {
+    long long target = (long long)(total * fraction);
+    long long seen = 0;
+    for(int us = 0; us <= HISTOGRAM_US; us++) {
+        seen += histogram[us];
+        if(seen > target) return us + 0.5;
+    }
+    return HISTOGRAM_US;
+}
+
+bool runLoadTest(int port, int connections, double seconds, LoadTestReport& report) {
+    memset(&report, 0, sizeof(report));
+    if(connections <= 0) connections = 1;
+    int threads = connections < MAX_CLIENT_THREADS ? connections : MAX_CLIENT_THREADS;
+    
+    ClientConnection* all = (ClientConnection*)calloc(connections, sizeof(ClientConnection));
+    unsigned* histograms = (unsigned*)calloc((size_t)threads * (HISTOGRAM_US + 1), sizeof(unsigned));
+    if(all == NULL || histograms == NULL) {
+        free(all);
+        free(histograms);
+        return false;
+    }
+    int opened = 0;
+    for(; opened < connections; opened++) {
+        all[opened].fd = connectLoopback(port);
+        if(all[opened].fd < 0) break;
+        all[opened].nextPath = opened % LOAD_TEST_PATH_COUNT;
+        all[opened].bodyLeft = -1;
+    }
+    if(opened < connections) {
+        fprintf(stderr, "load test: connection %d to port %d failed\n", opened + 1, port);
+        for(int i = 0; i < opened; i++) close(all[i].fd);
+        free(all);
+        free(histograms);
+        return false;
+    }
+    
+    static ClientThread clients[MAX_CLIENT_THREADS];
+    long long start = timerNow();
+    long long end = start + (long long)(seconds * 1e9);
+    int first = 0;
+    for(int t = 0; t < threads; t++) {
+        ClientThread& client = clients[t];
+        int count = connections / threads + (t < connections % threads ? 1 : 0);
+        client.connectionCount = count;
+        client.end = end;
+        client.requests = 0;
+        client.errors = 0;
+        client.maxNs = 0;
+        client.histogram = histograms + (size_t)t * (HISTOGRAM_US + 1);
+        client.connections = all + first;
+        client.thread = std::thread(runClient, &client);
+        first += count;
+    }
+    
+    // Merge into the first histogram. Connections that broke count as
+    // errors but have no latency, so the percentiles are taken over the
+    // responses that were timed.
+    for(int t = 0; t < threads; t++) {
+        ClientThread& client = clients[t];
+        client.thread.join();
+        report.requests += client.requests;
+        report.errors += client.errors;
+        if(client.maxNs / 1000.0 > report.maxUs) report.maxUs = client.maxNs / 1000.0;
+        if(t > 0) {
+            for(int us = 0; us <= HISTOGRAM_US; us++) histograms[us] += client.histogram[us];
+        }
+    }
+    report.seconds = timerMs(timerNow() - start) / 1000.0;
+    report.connections = connections;
+    report.threads = threads;
+    
+    long long total = 0;
+    for(int us = 0; us <= HISTOGRAM_US; us++) total += histograms[us];
+    if(total > 0) {
+        report.p50Us = histogramPercentile(histograms, total, 0.50);
+        report.p99Us = histogramPercentile(histograms, total, 0.99);
+        report.p999Us = histogramPercentile(histograms, total, 0.999);
+    }
+    for(int i = 0; i < connections; i++) close(all[i].fd);
+    free(all);
+    free(histograms);
+    return true;
+}
+
+#else
+
+bool runLoadTest(int, int, double, LoadTestReport& report) {
+    report = LoadTestReport();
+    fprintf(stderr, "load test: not available on this platform (needs epoll)\n");
+    return false;
+}
+
+#endif
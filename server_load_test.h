@@ -0,0 +1,29 @@
+#ifndef SERVER_LOAD_TEST_H
+#define SERVER_LOAD_TEST_H
+
+// Load generator for the element server (element_server.h). Opens a number
+// of keep-alive connections to 127.0.0.1, spread over a few client
+// threads, each with one request outstanding at a time. As soon as a
+// response is complete the next request goes out. The requests cycle
+// through a mix of element lookups, filters and formulas. Latency is
+// request sent to last byte received, kept in a microsecond histogram so
+// millions of samples cost no allocation.
+//
+// Linux only (epoll); elsewhere runLoadTest reports failure.
+
+struct LoadTestReport {
+    int connections;
+    int threads;
+    long long requests;   // completed with 200
+    long long errors;     // other statuses or failed connections
+    double seconds;
+    double p50Us;
+    double p99Us;
+    double p999Us;
+    double maxUs;
+};
+
+// Function to load the server on port for the given time
+bool runLoadTest(int port, int connections, double seconds, LoadTestReport& report);
+
+#endif
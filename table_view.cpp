@@ -0,0 +1,1917 @@
+#include "table_view.h"
+#include "element_query.h"
+#include "element_filter.h"
+#include "element_search.h"
+#include "electron_config.h"
+#include "bohr_diagram.h"
+#include "element_compare.h"
+#include "heatmap.h"
+#include "nuclide_chart.h"
+#include "timing.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+using namespace std;
+
+int legendX = WINDOW_WIDTH - 200;  // from the right edge once the window is open
+const int legendY = 100;
+const int popupWidth = 560;
+const int popupHeight = 290;
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+RenderBackend* gfx = NULL;
+
+// Visual states an element cell can be drawn in
+enum TileState {
+    TILE_NORMAL,
+    TILE_HOVERED,
+    TILE_SELECTED,
+    TILE_FILTERED,
+    TILE_STATE_COUNT
+};
+
+void drawCategoryLegend() {
+    const int boxW = 15;
+    const int spacing = 25;
+    
+    gfx->setTextStyle(FONT_SMALL, 5);
+    gfx->setColor(COLOR_WHITE);
+    gfx->text(legendX, legendY - 30, "Element Categories:");
+    
+    const char* categories[] = {
+        "Alkali Metals",
+        "Alkaline Earth",
+        "Transition Metals",
+        "Post-Transition",
+        "Metalloids",
+        "Nonmetals",
+        "Noble Gases",
+        "Lanthanides",
+        "Actinides"
+    };
+    
+    int colors[] = {
+        ALKALI_METAL,
+        ALKALINE_EARTH,
+        TRANSITION_METAL,
+        POST_TRANSITION,
+        METALLOID,
+        NONMETAL,
+        NOBLE_GAS,
+        LANTHANIDE,
+        ACTINIDE
+    };
+    
+    for(int i = 0; i < 9; i++) {
+        gfx->setFillColor(colors[i]);
+        gfx->bar(legendX, legendY + i*spacing, legendX + boxW, legendY + boxW + i*spacing);
+        gfx->setColor(COLOR_WHITE);
+        gfx->text(legendX + boxW + 5, legendY + i*spacing, categories[i]);
+    }
+}
+
+// Function to format a property value, or "-" if it is missing
+void formatValue(char* out, double value, const char* format) {
+    if(std::isnan(value)) sprintf(out, "-");
+    else sprintf(out, format, value);
+}
+
+// Function to sum up an element's nuclides in one short line: the most
+// abundant, or the longest-lived if none occur naturally
+void formatIsotopeSummary(char* out, int size, int z) {
+    const NuclideTable& table = nuclideTable();
+    int common = -1, longest = -1;
+    for(int i = table.first[z]; i < table.first[z + 1]; i++) {
+        const Nuclide& nuclide = table.nuclide[i];
+        if(nuclide.abundance > 0 && (common < 0 || nuclide.abundance > table.nuclide[common].abundance)) common = i;
+        if(!std::isnan(nuclide.halfLife) && (longest < 0 || nuclide.halfLife > table.nuclide[longest].halfLife)) longest = i;
+    }
+    const char* symbol = ELEMENTS[z - 1].symbol;
+    if(common >= 0) {
+        const Nuclide& nuclide = table.nuclide[common];
+        snprintf(out, size, "Most common: %d%s %.4g%%", z + nuclide.n, symbol, nuclide.abundance);
+    } else if(longest >= 0) {
+        const Nuclide& nuclide = table.nuclide[longest];
+        char halfLife[16];
+        formatHalfLife(halfLife, sizeof(halfLife), nuclide.halfLife);
+        snprintf(out, size, "Longest: %d%s %s", z + nuclide.n, symbol, halfLife);
+    } else {
+        snprintf(out, size, "No nuclide data");
+    }
+}
+
+struct Popup;
+void drawPopupDiagram(const Popup& popup);
+Rect popupRect(const Popup& popup);
+
+// Function to draw one detail panel. Drawn by the repaint pass for every
+// open popup; see openPopup and closePopup.
+void showElementDetails(const Popup& popup, const Element& elem) {
+    Rect r = popupRect(popup);
+    
+    gfx->setFillColor(COLOR_WHITE);
+    gfx->setColor(COLOR_BLACK);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    gfx->rectangle(r.left, r.top, r.right, r.bottom);
+    
+    gfx->setBackgroundColor(COLOR_WHITE);
+    gfx->setColor(COLOR_BLACK);
+    gfx->setTextStyle(FONT_GOTHIC, 2);
+    
+    char buffer[100];
+    sprintf(buffer, "%s (%s)", elem.name, elem.symbol);
+    gfx->text(r.left + 15, r.top + 15, buffer);
+    
+    gfx->setTextStyle(FONT_GOTHIC, 1);
+    sprintf(buffer, "Atomic Number: %d", elem.atomicNumber);
+    gfx->text(r.left + 15, r.top + 60, buffer);
+    
+    // Measured properties come from the data file and may be missing
+    const ElementColumns& columns = elementColumns();
+    int index = elem.atomicNumber - 1;
+    sprintf(buffer, "Atomic Weight: %.3f", columns.atomicWeight[index]);
+    gfx->text(r.left + 15, r.top + 90, buffer);
+    
+    sprintf(buffer, "Block: %s", elem.block);
+    gfx->text(r.left + 15, r.top + 120, buffer);
+    
+    char config[80];
+    formatElectronConfig(groundStateConfig(elem.atomicNumber), config, sizeof(config), true);
+    sprintf(buffer, "Config: %s", config);
+    gfx->text(r.left + 15, r.top + 150, buffer);
+    
+    // Per-shell totals come straight from the precomputed occupancy table
+    const unsigned char* shells = shellOccupancy(elem.atomicNumber);
+    int length = sprintf(buffer, "Shells:");
+    for(int i = 0; i < shellCount(elem.atomicNumber); i++) length += sprintf(buffer + length, " %d", shells[i]);
+    gfx->text(r.left + 15, r.top + 180, buffer);
+    
+    char radius[16], en[16], ionization[16];
+    formatValue(radius, columns.atomicRadius[index], "%.0f pm");
+    formatValue(en, columns.electronegativity[index], "%.2f");
+    formatValue(ionization, columns.ionizationEnergy[index], "%.2f eV");
+    sprintf(buffer, "Radius %s  EN %s  IE %s", radius, en, ionization);
+    gfx->text(r.left + 15, r.top + 210, buffer);
+    
+    char isotopes[48];
+    formatIsotopeSummary(isotopes, sizeof(isotopes), elem.atomicNumber);
+    gfx->text(r.left + 15, r.bottom - 55, isotopes);
+    gfx->text(r.left + 15, r.bottom - 30, "A: animate  +/-: fps  N: chart");
+    
+    drawPopupDiagram(popup);
+    
+    gfx->setBackgroundColor(COLOR_BLACK);
+}
+
+// ---------------------------------------------------------------------------
+// Zoom and pan
+//
+// The table is drawn through tableView (element_query.h), which places the
+// layout grid on screen at one of a fixed ladder of cell sizes. The window
+// opens at the largest size that fits between the title, the legend and the
+// popup strip, so the same layout fills a kiosk screen or a 4K wall. The
+// wheel zooms about the pointer, [ and ] about the middle of the table,
+// the arrows pan and 0 fits the table to the window again.
+//
+// Text follows the cell size: small cells show only the symbol, normal ones
+// the number, symbol and block, and large ones the name and weight as well.
+// ---------------------------------------------------------------------------
+
+const int ZOOM_LEVELS = 18;
+const int ZOOM_CELL_SIZES[ZOOM_LEVELS] = {
+    24, 28, 32, 36, 42, 48, 54, 60, 68, 76, 84, 96, 108, 120, 136, 152, 168, 192
+};
+
+// Detail thresholds, in pixels per cell
+const int LOD_NUMBER_CELL = 36;  // atomic number and block beside the symbol
+const int LOD_DETAIL_CELL = 96;  // name and atomic weight too
+
+ViewTransform tableView = LAYOUT_VIEW;
+int zoomLevel = 7;  // index into ZOOM_CELL_SIZES; 7 is boxSize
+
+// Function to give a cell's box on screen. The box includes its right and
+// bottom edge, like the BGI rectangle drawn around it.
+Rect cellBox(const Element& elem) {
+    int left = viewX(tableView, elem.x);
+    int top = viewY(tableView, elem.y);
+    Rect r = { left, top, left + tableView.cellSize, top + tableView.cellSize };
+    return r;
+}
+
+// Function to draw the text of a cell, as much of it as the cell size allows
+void drawElementText(const Element& elem, int color) {
+    Rect box = cellBox(elem);
+    int cell = tableView.cellSize;
+    gfx->setColor(color);
+    
+    if(cell < LOD_NUMBER_CELL) {
+        gfx->setTextStyle(FONT_SMALL, max(4, cell / 5));
+        gfx->text(box.left + cell / 5, box.top + cell / 4, elem.symbol);
+        return;
+    }
+    
+    // At boxSize these come to the fixed sizes the table was designed with
+    int small = min(10, cell / 12);
+    char num[5];
+    sprintf(num, "%d", elem.atomicNumber);
+    gfx->setTextStyle(FONT_SMALL, small);
+    gfx->text(box.left + cell / 12, box.top + cell / 12, num);
+    
+    gfx->setTextStyle(FONT_GOTHIC, max(1, cell / 30));
+    gfx->text(box.left + cell / 4, box.top + cell / 3, elem.symbol);
+    
+    gfx->setTextStyle(FONT_SMALL, small);
+    if(cell < LOD_DETAIL_CELL) {
+        gfx->text(box.left + cell - cell / 4, box.top + cell - cell / 4, elem.block);
+        return;
+    }
+    
+    // Large cells: the block moves up to make room for two more lines
+    char weight[16];
+    formatValue(weight, elementColumns().atomicWeight[elem.atomicNumber - 1], "%.4g");
+    gfx->text(box.left + cell - cell / 4, box.top + cell / 12, elem.block);
+    gfx->text(box.left + cell / 12, box.top + cell * 5 / 8, elem.name);
+    gfx->text(box.left + cell / 12, box.top + cell * 13 / 16, weight);
+}
+
+// Function to draw a single element box with improved styling
+void drawElement(const Element& elem, int state = TILE_NORMAL) {
+    int textColor = state == TILE_FILTERED ? COLOR_DARKGRAY : elem.color;
+    int borderColor = textColor;
+    if(state == TILE_HOVERED) borderColor = COLOR_WHITE;
+    if(state == TILE_SELECTED) borderColor = COLOR_YELLOW;
+    
+    Rect box = cellBox(elem);
+    gfx->setColor(borderColor);
+    gfx->setLineWidth(LINE_THICK);
+    gfx->rectangle(box.left, box.top, box.right, box.bottom);
+    
+    drawElementText(elem, textColor);
+}
+
+// ---------------------------------------------------------------------------
+// Retained-mode repaint
+//
+// Handlers never draw directly. They change state (hover, popups) and mark
+// the affected screen regions dirty; repaintDirty then clears only those
+// regions and redraws the title, legend, cells and popups that overlap them.
+// ---------------------------------------------------------------------------
+
+const int MAX_DIRTY_RECTS = 32;
+Rect dirtyRects[MAX_DIRTY_RECTS];
+int dirtyCount = 0;
+
+int hoveredIndex = -1;
+
+// Detail popups are non-modal panels; several can be open side by side for
+// comparison. Each sits in one of up to four non-overlapping slots, as many
+// as fit the window (see popupSlotRect), and keeps a save-under copy of the
+// screen beneath it, so closing it is one blit instead of a repaint. The
+// last one opened has focus for the keys.
+const int MAX_POPUPS = 4;
+
+struct Popup {
+    int element;
+    int slot;
+    void* saveUnder;
+    bool saveUnderValid;  // false once something beneath it was repainted
+};
+
+Popup popups[MAX_POPUPS];
+int popupCount = 0;  // in opening order; the last is on top
+
+// Save-unders of popups closed this frame, put back before repainting
+struct Restore {
+    Rect rect;
+    void* image;
+};
+
+Restore restores[MAX_POPUPS];
+int restoreCount = 0;
+
+bool rectsIntersect(const Rect& a, const Rect& b) {
+    return a.left <= b.right && b.left <= a.right &&
+           a.top <= b.bottom && b.top <= a.bottom;
+}
+
+Rect rectUnion(const Rect& a, const Rect& b) {
+    Rect r;
+    r.left = min(a.left, b.left);
+    r.top = min(a.top, b.top);
+    r.right = max(a.right, b.right);
+    r.bottom = max(a.bottom, b.bottom);
+    return r;
+}
+
+bool rectInside(const Rect& inner, const Rect& outer) {
+    return inner.left >= outer.left && inner.right <= outer.right &&
+           inner.top >= outer.top && inner.bottom <= outer.bottom;
+}
+
+Rect makeRect(int left, int top, int right, int bottom) {
+    Rect r = { left, top, right, bottom };
+    return r;
+}
+
+// Thick box outlines spill one pixel outside the nominal cell
+Rect elementRect(const Element& elem) {
+    Rect box = cellBox(elem);
+    return makeRect(box.left - 1, box.top - 1, box.right + 1, box.bottom + 1);
+}
+
+Rect titleRect() {
+    return makeRect(0, 0, gfx->maxX(), baseY - 2);
+}
+
+Rect legendRect() {
+    return makeRect(legendX, legendY - 30, gfx->maxX(), legendY + 9 * 25);
+}
+
+Rect statusRect() {
+    return makeRect(0, gfx->maxY() - 24, gfx->maxX(), gfx->maxY());
+}
+
+// The first two slots sit side by side in the strip below the table, so
+// two elements can be compared without hiding any of it; the next two stack
+// above them. A popup's size is set by its text and Bohr diagram, so a
+// smaller window offers fewer slots rather than smaller popups: at the
+// 800x600 minimum only the first fits.
+Rect popupSlotRect(int slot) {
+    int left = 40 + (slot % 2) * (popupWidth + 40);
+    int top = statusRect().top - 8 - popupHeight - (slot / 2) * (popupHeight + 10);
+    return makeRect(left, top, left + popupWidth, top + popupHeight);
+}
+
+bool popupSlotFits(int slot) {
+    Rect r = popupSlotRect(slot);
+    return r.left >= 0 && r.top >= 0 && r.right <= gfx->maxX() && r.bottom < statusRect().top;
+}
+
+Rect popupRect(const Popup& popup) {
+    return popupSlotRect(popup.slot);
+}
+
+// The comparison panel shares the strip below the table with the first two
+// popup slots; popups draw over it
+Rect compareRect() {
+    int bottom = statusRect().top - 8;
+    return makeRect(40, bottom - popupHeight, gfx->maxX() - 40, bottom);
+}
+
+const int COMPARE_HEADER_HEIGHT = 56;
+const int COMPARE_ROW_HEIGHT = 26;
+
+Rect compareRowRect(int row) {
+    Rect panel = compareRect();
+    int top = panel.top + COMPARE_HEADER_HEIGHT + row * COMPARE_ROW_HEIGHT;
+    return makeRect(panel.left + 1, top, panel.right - 1, top + COMPARE_ROW_HEIGHT - 1);
+}
+
+Rect popupDiagramRect(const Popup& popup) {
+    Rect r = popupRect(popup);
+    return bohrDiagramRect(r.right - BOHR_RADIUS - 15, (r.top + r.bottom) / 2);
+}
+
+Rect screenRect() {
+    return makeRect(0, 0, gfx->maxX(), gfx->maxY());
+}
+
+// Overlapping regions are merged so no pixel is cleared and redrawn twice
+// in one pass. Cells can be panned partly or wholly off screen, so regions
+// are clipped to it and those left empty dropped.
+void invalidateRect(Rect r) {
+    r.left = max(r.left, 0);
+    r.top = max(r.top, 0);
+    r.right = min(r.right, gfx->maxX());
+    r.bottom = min(r.bottom, gfx->maxY());
+    if(r.left > r.right || r.top > r.bottom) return;
+    
+    bool merged = true;
+    while(merged) {
+        merged = false;
+        for(int i = 0; i < dirtyCount; i++) {
+            if(rectsIntersect(r, dirtyRects[i])) {
+                r = rectUnion(r, dirtyRects[i]);
+                dirtyRects[i] = dirtyRects[--dirtyCount];
+                merged = true;
+                break;
+            }
+        }
+    }
+    
+    if(dirtyCount == MAX_DIRTY_RECTS) {
+        // Out of slots: fold everything into one region
+        for(int i = 1; i < dirtyCount; i++) dirtyRects[0] = rectUnion(dirtyRects[0], dirtyRects[i]);
+        dirtyRects[0] = rectUnion(dirtyRects[0], r);
+        dirtyCount = 1;
+        return;
+    }
+    dirtyRects[dirtyCount++] = r;
+}
+
+void drawTitle() {
+    gfx->setTextStyle(FONT_GOTHIC, 3);
+    gfx->setColor(COLOR_WHITE);
+    gfx->text(baseX, 5, "Interactive Periodic Table of Elements");
+}
+
+// ---------------------------------------------------------------------------
+// Tile cache
+//
+// Every cell's outline and text are static, so each (element, state) pair is
+// rasterized once with drawElement, captured with getimage and afterwards
+// drawn with a single putimage. Normal tiles are built at startup; the other
+// states are built the first time they are needed.
+//
+// Tiles don't depend on where the cell is, so panning only blits. Each zoom
+// level has its own tiles, built as its cells come into view; zooming back
+// to a level visited recently blits again. The tiles of the least recently
+// used level are freed once more than MAX_TILE_LEVELS are held, as cells
+// at the top of the ladder take some 150 KB each. Cells partly off screen
+// are drawn directly, since a tile can only be captured from the screen.
+// ---------------------------------------------------------------------------
+
+const int MAX_TILE_LEVELS = 4;
+
+void* tileCache[ZOOM_LEVELS][ELEMENT_COUNT][TILE_STATE_COUNT] = {};
+void* stencilCache[ZOOM_LEVELS][ELEMENT_COUNT] = {};
+unsigned levelUsed[ZOOM_LEVELS] = {};  // when each level was last shown; 0 if it holds nothing
+unsigned levelClock = 0;
+
+// Function to free one level's tiles and stencils
+void freeTileLevel(int level) {
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        for(int state = 0; state < TILE_STATE_COUNT; state++) {
+            free(tileCache[level][i][state]);
+            tileCache[level][i][state] = NULL;
+        }
+        free(stencilCache[level][i]);
+        stencilCache[level][i] = NULL;
+    }
+    levelUsed[level] = 0;
+}
+
+// Function to drop an element's tiles at the levels large enough to show its
+// atomic weight, after the loaded value changed
+void discardDetailTiles(int index) {
+    for(int level = 0; level < ZOOM_LEVELS; level++) {
+        if(ZOOM_CELL_SIZES[level] < LOD_DETAIL_CELL) continue;
+        for(int state = 0; state < TILE_STATE_COUNT; state++) {
+            free(tileCache[level][index][state]);
+            tileCache[level][index][state] = NULL;
+        }
+        free(stencilCache[level][index]);
+        stencilCache[level][index] = NULL;
+    }
+}
+
+// Function to mark the current level as used, making room for it first if
+// it holds nothing yet
+void touchTileLevel() {
+    if(levelUsed[zoomLevel] == 0) {
+        int held = 0, oldest = -1;
+        for(int level = 0; level < ZOOM_LEVELS; level++) {
+            if(levelUsed[level] == 0) continue;
+            held++;
+            if(oldest < 0 || levelUsed[level] < levelUsed[oldest]) oldest = level;
+        }
+        if(held >= MAX_TILE_LEVELS) freeTileLevel(oldest);
+    }
+    levelUsed[zoomLevel] = ++levelClock;
+}
+
+// Function to tell whether a cell can be captured as a tile where it is now
+bool cellOnScreen(const Element& elem) {
+    return rectInside(elementRect(elem), screenRect());
+}
+
+// Function to rasterize one tile at the cell's own position and capture it
+void* buildTile(const Element& elem, int state) {
+    Rect r = elementRect(elem);
+    void* tile = malloc(gfx->imageSize(r));
+    if(tile == NULL) return NULL;
+    
+    gfx->setFillColor(COLOR_BLACK);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    drawElement(elem, state);
+    gfx->getImage(r, tile);
+    return tile;
+}
+
+// ---------------------------------------------------------------------------
+// Heatmap
+//
+// H cycles the cell colors through each numeric property (see
+// ElementProperty) and back to the categories. Levels come precomputed
+// from heatmapTable() and index a palette built once from the ramp. Cells
+// are tinted rather than re-rasterized: each has a stencil tile with its
+// text in black on white, and a heat cell is a bar in its color with the
+// stencil ANDed over it. Switching property draws no text at all, only
+// bars, blits and outlines. Dimmed cells keep their normal dimmed tile.
+// ---------------------------------------------------------------------------
+
+int heatmapProperty = -1;  // PROP_ value, or -1 for category colors
+int heatPalette[HEATMAP_STEPS];
+
+// Function to rasterize a cell's text in black on white and capture it
+void* buildStencil(const Element& elem) {
+    Rect r = elementRect(elem);
+    void* stencil = malloc(gfx->imageSize(r));
+    if(stencil == NULL) return NULL;
+    
+    gfx->setFillColor(COLOR_WHITE);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    gfx->setBackgroundColor(COLOR_WHITE);
+    drawElementText(elem, COLOR_BLACK);
+    gfx->setBackgroundColor(COLOR_BLACK);
+    gfx->getImage(r, stencil);
+    return stencil;
+}
+
+// Function to draw a cell tinted with its heat color; cells without a
+// value for the property are gray
+void drawHeatTile(const Element elements[], int index, int state) {
+    const Element& elem = elements[index];
+    Rect r = elementRect(elem);
+    int level = heatmapTable().level[heatmapProperty][index];
+    int fill = level >= 0 ? heatPalette[level] : COLOR_DARKGRAY;
+    
+    void*& stencil = stencilCache[zoomLevel][index];
+    if(stencil == NULL && cellOnScreen(elem)) stencil = buildStencil(elem);
+    
+    gfx->setFillColor(fill);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    if(stencil != NULL) gfx->putImage(r.left, r.top, stencil, IMAGE_AND);
+    else drawElementText(elem, COLOR_BLACK);  // off screen or out of memory: draw directly
+    
+    int borderColor = COLOR_BLACK;
+    if(state == TILE_HOVERED) borderColor = COLOR_WHITE;
+    if(state == TILE_SELECTED) borderColor = COLOR_YELLOW;
+    Rect box = cellBox(elem);
+    gfx->setColor(borderColor);
+    gfx->setLineWidth(LINE_THICK);
+    gfx->rectangle(box.left, box.top, box.right, box.bottom);
+}
+
+// Function to draw the ramp with the property's quantiles beside it
+void drawHeatLegend() {
+    const int boxW = 15;
+    const int stepHeight = 6;
+    const PropertyScale& scale = heatmapTable().scale[heatmapProperty];
+    
+    gfx->setTextStyle(FONT_SMALL, 5);
+    gfx->setColor(COLOR_WHITE);
+    char title[48];
+    sprintf(title, "Heatmap: %s", propertyName(heatmapProperty));
+    gfx->text(legendX, legendY - 30, title);
+    
+    // Highest value at the top
+    int bottom = legendY + HEATMAP_STEPS * stepHeight;
+    for(int i = 0; i < HEATMAP_STEPS; i++) {
+        gfx->setFillColor(heatPalette[i]);
+        gfx->bar(legendX, bottom - (i + 1) * stepHeight, legendX + boxW, bottom - i * stepHeight - 1);
+    }
+    
+    if(scale.count == 0) {
+        gfx->text(legendX + boxW + 5, legendY, "no values yet");
+        return;
+    }
+    for(int k = 0; k <= HEATMAP_QUANTILES; k += 2) {
+        char label[32];
+        sprintf(label, "%.4g (%d%%)", scale.quantile[k], k * 100 / HEATMAP_QUANTILES);
+        int y = bottom - k * HEATMAP_STEPS * stepHeight / HEATMAP_QUANTILES - 6;
+        gfx->text(legendX + boxW + 5, y, label);
+    }
+}
+
+void drawLegend() {
+    if(heatmapProperty >= 0) drawHeatLegend();
+    else drawCategoryLegend();
+}
+
+// Function to switch to the next property (or back to categories). Every
+// cell is repainted, so one region covering them all is invalidated rather
+// than 118 small ones.
+void cycleHeatmap(const Element elements[]) {
+    heatmapProperty++;
+    if(heatmapProperty >= PROP_COUNT) heatmapProperty = -1;
+    
+    Rect cells = elementRect(elements[0]);
+    for(int i = 1; i < ELEMENT_COUNT; i++) cells = rectUnion(cells, elementRect(elements[i]));
+    invalidateRect(cells);
+    invalidateRect(legendRect());
+}
+
+// Function to build the palette from the ramp and every cell's stencil, so
+// the first switch to a heatmap is as quick as the rest
+void initHeatmap(const Element elements[], int count) {
+    for(int i = 0; i < HEATMAP_STEPS; i++) {
+        const RampColor& c = HEATMAP_RAMP.color[i];
+        heatPalette[i] = gfx->rgbColor(c.red, c.green, c.blue);
+    }
+    for(int i = 0; i < count; i++) {
+        if(cellOnScreen(elements[i])) stencilCache[zoomLevel][i] = buildStencil(elements[i]);
+    }
+    heatmapTable();
+}
+
+// Function to draw a cell from the cache, building the tile if needed
+void drawElementTile(const Element elements[], int index, int state) {
+    if(heatmapProperty >= 0 && state != TILE_FILTERED) {
+        drawHeatTile(elements, index, state);
+        return;
+    }
+    
+    void*& tile = tileCache[zoomLevel][index][state];
+    if(tile == NULL && cellOnScreen(elements[index])) tile = buildTile(elements[index], state);
+    
+    if(tile == NULL) {
+        drawElement(elements[index], state);  // off screen or out of memory: draw directly
+        return;
+    }
+    Rect r = elementRect(elements[index]);
+    gfx->putImage(r.left, r.top, tile, IMAGE_COPY);
+}
+
+// Function to build all normal-state tiles and report what the cache saves:
+// the cold-start cost of rasterizing them and the steady-state cost of a
+// full redraw with and without the cache. Draws on the active page, which
+// the first frame overwrites.
+void initTileCache(const Element elements[], int count) {
+    long long start = timerNow();
+    touchTileLevel();
+    for(int i = 0; i < count; i++) {
+        if(cellOnScreen(elements[i])) tileCache[zoomLevel][i][TILE_NORMAL] = buildTile(elements[i], TILE_NORMAL);
+    }
+    double coldMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int i = 0; i < count; i++) {
+        drawElement(elements[i]);
+    }
+    double rasterMs = timerMs(timerNow() - start);
+    
+    start = timerNow();
+    for(int i = 0; i < count; i++) {
+        drawElementTile(elements, i, TILE_NORMAL);
+    }
+    double blitMs = timerMs(timerNow() - start);
+    
+    cout << "tile cache: cold start " << coldMs << " ms; full redraw "
+         << rasterMs << " ms rasterized vs " << blitMs << " ms from tiles" << endl;
+}
+
+// ---------------------------------------------------------------------------
+// Filter and search
+//
+// Press F to type a filter expression (see element_filter.h) or / to search
+// by name, symbol or atomic number (see element_search.h). Both are
+// re-evaluated on every keystroke, and a cell is dimmed unless it passes
+// both. Only cells whose match state changed are invalidated, so typing
+// repaints a handful of tiles rather than the whole table. The best search
+// match is highlighted as you type and Enter opens it; in the filter Enter
+// just returns to the table. Escape clears the text being edited.
+// ---------------------------------------------------------------------------
+
+enum InputMode {
+    INPUT_NONE,
+    INPUT_FILTER,
+    INPUT_SEARCH
+};
+
+const int INPUT_TEXT_SIZE = 64;
+int inputMode = INPUT_NONE;
+char filterText[INPUT_TEXT_SIZE] = "";
+char searchText[INPUT_TEXT_SIZE] = "";
+bool filterValid = true;
+char filterError[64] = "";
+double queryUs = 0;        // evaluation time of the last keystroke
+int searchHitIndex = -1;   // best search match, drawn highlighted
+
+ElementMask filterMask = fullMask(ELEMENT_COUNT);
+ElementMask searchMask = fullMask(ELEMENT_COUNT);
+ElementMask visibleMask = fullMask(ELEMENT_COUNT);  // cells not dimmed
+
+// Function to show the cells passing both filter and search, repainting
+// only those whose state changed
+void updateVisibleMask(const Element elements[]) {
+    ElementMask mask = maskAnd(filterMask, searchMask);
+    ElementMask changed = maskOr(maskAndNot(mask, visibleMask), maskAndNot(visibleMask, mask));
+    for(int i = 0; i < ELEMENT_COUNT; i++) {
+        if(maskTest(changed, i)) invalidateRect(elementRect(elements[i]));
+    }
+    visibleMask = mask;
+}
+
+// Function to re-run the filter after the text changed. While the user is
+// in the middle of an expression that does not parse yet, the last good
+// result stays on screen.
+void applyFilterText(const Element elements[]) {
+    long long start = timerNow();
+    ElementFilter filter;
+    filterValid = parseFilter(filterText, filter);
+    if(filterValid) {
+        filterMask = evaluateFilter(filter, elementColumns());
+        queryUs = timerMs(timerNow() - start) * 1000.0;
+        updateVisibleMask(elements);
+    } else {
+        snprintf(filterError, sizeof(filterError), "%s", filter.error);
+    }
+    invalidateRect(statusRect());
+}
+
+// Function to re-run the search after the text changed
+void applySearchText(const Element elements[]) {
+    long long start = timerNow();
+    int best = -1;
+    if(searchText[0] != '\0') {
+        searchMask = searchElements(searchText);
+        best = bestSearchMatch(searchText);
+    } else {
+        searchMask = fullMask(ELEMENT_COUNT);
+    }
+    queryUs = timerMs(timerNow() - start) * 1000.0;
+    
+    if(best != searchHitIndex) {
+        if(searchHitIndex >= 0) invalidateRect(elementRect(elements[searchHitIndex]));
+        if(best >= 0) invalidateRect(elementRect(elements[best]));
+        searchHitIndex = best;
+    }
+    updateVisibleMask(elements);
+    invalidateRect(statusRect());
+}
+
+void drawStatusLine() {
+    char line[200];
+    int matches = maskCount(visibleMask);
+    
+    if(inputMode == INPUT_FILTER && !filterValid) {
+        snprintf(line, sizeof(line), "Filter: %s_    %s", filterText, filterError);
+    } else if(inputMode == INPUT_FILTER) {
+        snprintf(line, sizeof(line), "Filter: %s_    %d matches (%.1f us)", filterText, matches, queryUs);
+    } else if(inputMode == INPUT_SEARCH) {
+        snprintf(line, sizeof(line), "Search: %s_    %d matches (%.1f us)%s", searchText, matches, queryUs,
+                 searchHitIndex >= 0 ? "    Enter: open" : "");
+    } else if(filterText[0] != '\0' || searchText[0] != '\0') {
+        snprintf(line, sizeof(line), "Filter: %s    Search: %s    %d matches    F, /: edit  Esc: clear",
+                 filterText[0] ? filterText : "-", searchText[0] ? searchText : "-", matches);
+    } else {
+        snprintf(line, sizeof(line), "F: filter (e.g. block=d & weight>50)    /: search    Shift+click: compare    H: heatmap    N: nuclides    Wheel, [ ]: zoom    Arrows: pan    B: back buffer on/off");
+    }
+    
+    Rect r = statusRect();
+    gfx->setTextStyle(FONT_SMALL, 5);
+    gfx->setColor(inputMode == INPUT_FILTER && !filterValid ? COLOR_LIGHTRED : COLOR_LIGHTGRAY);
+    gfx->text(baseX, r.top + 4, line);
+}
+
+// Function to re-evaluate whichever text the input line is editing
+void applyInputText(const Element elements[]) {
+    if(inputMode == INPUT_SEARCH) applySearchText(elements);
+    else applyFilterText(elements);
+}
+
+void openPopup(const Element elements[], int index);
+
+// Function to handle a key while the input line has focus
+void handleInputKey(const Element elements[], int key) {
+    char* text = inputMode == INPUT_SEARCH ? searchText : filterText;
+    int length = strlen(text);
+    
+    if(key == KEY_ENTER) {
+        if(inputMode == INPUT_SEARCH && searchHitIndex >= 0) openPopup(elements, searchHitIndex);
+        inputMode = INPUT_NONE;
+        invalidateRect(statusRect());
+        return;
+    }
+    if(key == KEY_ESCAPE) {
+        text[0] = '\0';
+        applyInputText(elements);
+        inputMode = INPUT_NONE;
+        return;
+    }
+    if(key == KEY_BACKSPACE) {
+        if(length == 0) return;
+        text[length - 1] = '\0';
+    } else if(key >= 32 && key < 127 && length < INPUT_TEXT_SIZE - 1) {
+        text[length] = (char)key;
+        text[length + 1] = '\0';
+    } else {
+        return;
+    }
+    applyInputText(elements);
+}
+
+// ---------------------------------------------------------------------------
+// Comparison panel
+//
+// Shift+click cells to add them to (or remove them from) a comparison of up
+// to MAX_COMPARE elements; X clears it. The panel lists each element's
+// properties with the difference from the first one picked and its rank in
+// the selection, plus bars scaled to the selection's largest value. Each
+// change recomputes the whole comparison in one batched pass
+// (compareElements), then only the rows whose contents changed are
+// invalidated.
+// ---------------------------------------------------------------------------
+
+// Row layout, from the row's left edge. In the default window the three
+// property columns are 190 px apart with the bars after the block column;
+// a narrower panel (--size goes down to 800 px) closes the columns up so
+// the block still fits, and the bars take whatever width is left, or are
+// left out when that is too little to read.
+const int COMPARE_NAME_WIDTH = 150;
+const int COMPARE_COLUMN_PITCH = 190;
+const int COMPARE_BLOCK_WIDTH = 60;
+const int COMPARE_BAR_MARGIN = 50;
+const int COMPARE_MIN_BAR_WIDTH = 60;
+
+struct CompareLayout {
+    int pitch;     // from one property's value to the next; diff and rank scale with it
+    int block;
+    int barLeft;
+    int barWidth;  // 0 when there is no room for bars
+};
+
+// The panel shows the first three properties; the rest don't fit
+const int COMPARE_COLUMNS = 3;
+const int compareProperties[COMPARE_COLUMNS] = { PROP_ATOMIC_WEIGHT, PROP_ATOMIC_RADIUS, PROP_ELECTRONEGATIVITY };
+const int compareBarColors[COMPARE_COLUMNS] = { COLOR_LIGHTBLUE, COLOR_LIGHTGREEN, COLOR_YELLOW };
+
+// Everything a row shows, so rows can be diffed against what is on screen
+struct CompareRow {
+    int element;
+    double value[COMPARE_COLUMNS];
+    double delta[COMPARE_COLUMNS];
+    int rank[COMPARE_COLUMNS];
+    int bar[COMPARE_COLUMNS];
+};
+
+int compareSelection[MAX_COMPARE];
+int compareCount = 0;
+CompareRow compareRows[MAX_COMPARE];
+int shownCompareCount = 0;
+
+CompareLayout compareLayout() {
+    Rect panel = compareRect();
+    int width = panel.right - panel.left;
+    CompareLayout layout;
+    layout.pitch = min(COMPARE_COLUMN_PITCH, (width - COMPARE_NAME_WIDTH - COMPARE_BLOCK_WIDTH) / COMPARE_COLUMNS);
+    layout.block = COMPARE_NAME_WIDTH + COMPARE_COLUMNS * layout.pitch;
+    layout.barLeft = layout.block + 10;
+    layout.barWidth = width - layout.barLeft - COMPARE_BAR_MARGIN;
+    if(layout.barWidth < COMPARE_MIN_BAR_WIDTH) layout.barWidth = 0;
+    return layout;
+}
+
+bool inComparison(int index) {
+    for(int i = 0; i < compareCount; i++) {
+        if(compareSelection[i] == index) return true;
+    }
+    return false;
+}
+
+// Function to recompute the comparison and invalidate what it changed
+void updateComparison() {
+    Comparison comparison;
+    compareElements(elementColumns(), compareSelection, compareCount, comparison);
+    
+    int barWidth = compareLayout().barWidth;
+    CompareRow rows[MAX_COMPARE];
+    memset(rows, 0, sizeof(rows));  // padding too, so rows compare with memcmp
+    for(int i = 0; i < compareCount; i++) {
+        rows[i].element = comparison.elements[i];
+        for(int p = 0; p < COMPARE_COLUMNS; p++) {
+            int property = compareProperties[p];
+            double value = comparison.value[property][i];
+            double max = comparison.maxValue[property];
+            rows[i].value[p] = value;
+            rows[i].delta[p] = comparison.delta[property][i];
+            rows[i].rank[p] = comparison.rank[property][i];
+            rows[i].bar[p] = (value > 0 && max > 0) ? (int)(value / max * barWidth) : 0;
+        }
+    }
+    
+    if((compareCount > 0) != (shownCompareCount > 0)) {
+        invalidateRect(compareRect());  // panel appears or goes away
+    } else if(compareCount > 0) {
+        if(compareCount != shownCompareCount) {
+            Rect panel = compareRect();
+            invalidateRect(makeRect(panel.left, panel.top, panel.right, panel.top + COMPARE_HEADER_HEIGHT - 1));
+        }
+        for(int i = 0; i < max(compareCount, shownCompareCount); i++) {
+            if(memcmp(&rows[i], &compareRows[i], sizeof(CompareRow)) != 0) invalidateRect(compareRowRect(i));
+        }
+    }
+    memcpy(compareRows, rows, sizeof(rows));
+    shownCompareCount = compareCount;
+}
+
+// Function to add an element to the comparison, or take it out again
+void toggleComparison(const Element elements[], int index) {
+    int at = -1;
+    for(int i = 0; i < compareCount; i++) {
+        if(compareSelection[i] == index) at = i;
+    }
+    
+    if(at >= 0) {
+        for(int i = at; i + 1 < compareCount; i++) compareSelection[i] = compareSelection[i + 1];
+        compareCount--;
+    } else if(compareCount < MAX_COMPARE) {
+        compareSelection[compareCount++] = index;
+    } else {
+        return;
+    }
+    invalidateRect(elementRect(elements[index]));
+    updateComparison();
+}
+
+void clearComparison(const Element elements[]) {
+    for(int i = 0; i < compareCount; i++) invalidateRect(elementRect(elements[compareSelection[i]]));
+    compareCount = 0;
+    updateComparison();
+}
+
+void drawCompareRow(const Element elements[], int row) {
+    const CompareRow& data = compareRows[row];
+    const Element& elem = elements[data.element];
+    Rect r = compareRowRect(row);
+    CompareLayout layout = compareLayout();
+    const char* valueFormats[COMPARE_COLUMNS] = { "%.3f", "%.0f", "%.2f" };
+    const char* deltaFormats[COMPARE_COLUMNS] = { "%+.3f", "%+.0f", "%+.2f" };
+    
+    char buffer[40];
+    gfx->setColor(elem.color);
+    sprintf(buffer, "%s  %s", elem.symbol, elem.name);
+    gfx->text(r.left + 10, r.top + 6, buffer);
+    
+    gfx->setColor(COLOR_WHITE);
+    for(int p = 0; p < COMPARE_COLUMNS; p++) {
+        int x = r.left + COMPARE_NAME_WIDTH + p * layout.pitch;
+        formatValue(buffer, data.value[p], valueFormats[p]);
+        gfx->text(x, r.top + 6, buffer);
+        if(row == 0) sprintf(buffer, "ref");
+        else formatValue(buffer, data.delta[p], deltaFormats[p]);
+        gfx->text(x + layout.pitch * 75 / COMPARE_COLUMN_PITCH, r.top + 6, buffer);
+        if(data.rank[p] > 0) sprintf(buffer, "#%d", data.rank[p]);
+        else sprintf(buffer, "-");
+        gfx->text(x + layout.pitch * 150 / COMPARE_COLUMN_PITCH, r.top + 6, buffer);
+    }
+    gfx->text(r.left + layout.block, r.top + 6, elem.block);
+    
+    for(int p = 0; p < COMPARE_COLUMNS; p++) {
+        if(data.bar[p] == 0) continue;
+        int top = r.top + 4 + p * 7;
+        gfx->setFillColor(compareBarColors[p]);
+        gfx->bar(r.left + layout.barLeft, top, r.left + layout.barLeft + data.bar[p], top + 4);
+    }
+}
+
+// Function to draw the parts of the comparison panel that overlap r
+void drawComparison(const Element elements[], const Rect& r) {
+    Rect panel = compareRect();
+    gfx->setLineWidth(LINE_NORMAL);
+    gfx->setColor(COLOR_DARKGRAY);
+    gfx->rectangle(panel.left, panel.top, panel.right, panel.bottom);
+    gfx->setTextStyle(FONT_SMALL, 5);
+    
+    if(r.top < panel.top + COMPARE_HEADER_HEIGHT) {
+        char title[80];
+        sprintf(title, "Comparing %d element%s (Shift+click to add or remove, X to clear)",
+                compareCount, compareCount == 1 ? "" : "s");
+        gfx->setColor(COLOR_WHITE);
+        gfx->text(panel.left + 10, panel.top + 8, title);
+        
+        const char* headings[COMPARE_COLUMNS] = { "Weight", "Radius (pm)", "Electroneg." };
+        gfx->setColor(COLOR_LIGHTGRAY);
+        CompareLayout layout = compareLayout();
+        gfx->text(panel.left + 10, panel.top + 32, "Element");
+        for(int p = 0; p < COMPARE_COLUMNS; p++) {
+            int x = panel.left + COMPARE_NAME_WIDTH + p * layout.pitch;
+            gfx->setColor(compareBarColors[p]);
+            gfx->text(x, panel.top + 32, headings[p]);
+            gfx->setColor(COLOR_LIGHTGRAY);
+            gfx->text(x + layout.pitch * 75 / COMPARE_COLUMN_PITCH, panel.top + 32, "diff");
+            gfx->text(x + layout.pitch * 150 / COMPARE_COLUMN_PITCH, panel.top + 32, "rank");
+        }
+        gfx->text(panel.left + layout.block, panel.top + 32, "Block");
+    }
+    
+    for(int i = 0; i < compareCount; i++) {
+        if(rectsIntersect(r, compareRowRect(i))) drawCompareRow(elements, i);
+    }
+}
+
+int popupFor(int index) {
+    for(int i = 0; i < popupCount; i++) {
+        if(popups[i].element == index) return i;
+    }
+    return -1;
+}
+
+// Function to pick the visual state of a cell from the view state
+int elementState(int index) {
+    if(popupFor(index) >= 0 || inComparison(index)) return TILE_SELECTED;
+    if(index == hoveredIndex || index == searchHitIndex) return TILE_HOVERED;
+    if(!maskTest(visibleMask, index)) return TILE_FILTERED;
+    return TILE_NORMAL;
+}
+
+bool chartOpen = false;
+void repaintChart(const Rect& r);
+
+// Function to repaint every dirty region, back to front
+void repaintDirty(const Element elements[], int count) {
+    for(int d = 0; d < dirtyCount; d++) {
+        const Rect& r = dirtyRects[d];
+        if(chartOpen) {
+            repaintChart(r);
+            continue;
+        }
+        
+        // Animation frames only touch the diagram inside a popup
+        int diagram = -1;
+        for(int i = 0; i < popupCount; i++) {
+            if(rectInside(r, popupDiagramRect(popups[i]))) diagram = i;
+        }
+        if(diagram >= 0) {
+            drawPopupDiagram(popups[diagram]);
+            continue;
+        }
+        
+        gfx->setFillColor(COLOR_BLACK);
+        gfx->bar(r.left, r.top, r.right, r.bottom);
+        
+        // Cells are redrawn whole, so the area touched can extend past r.
+        // Neighbouring outlines share pixels; highlighted cells go last so
+        // their outline is not painted over by a neighbour's.
+        Rect touched = r;
+        for(int pass = 0; pass < 2; pass++) {
+            for(int i = 0; i < count; i++) {
+                Rect cell = elementRect(elements[i]);
+                if(!rectsIntersect(r, cell)) continue;
+                
+                int state = elementState(i);
+                bool highlighted = state == TILE_HOVERED || state == TILE_SELECTED;
+                if(highlighted != (pass == 1)) continue;
+                drawElementTile(elements, i, state);
+                touched = rectUnion(touched, cell);
+            }
+        }
+        
+        // A zoomed or panned table can run under the title, legend and
+        // status line; they are drawn over it, each on its own background
+        const Rect chrome[3] = { titleRect(), legendRect(), statusRect() };
+        for(int c = 0; c < 3; c++) {
+            if(!rectsIntersect(touched, chrome[c])) continue;
+            gfx->setFillColor(COLOR_BLACK);
+            gfx->bar(chrome[c].left, chrome[c].top, chrome[c].right, chrome[c].bottom);
+        }
+        if(rectsIntersect(touched, titleRect())) drawTitle();
+        if(rectsIntersect(touched, legendRect())) drawLegend();
+        if(rectsIntersect(touched, statusRect())) drawStatusLine();
+        
+        if(compareCount > 0 && rectsIntersect(r, compareRect())) drawComparison(elements, r);
+        
+        // What is under a popup just changed. If all of it was redrawn the
+        // save-under can be refreshed now, before the panel covers it again;
+        // otherwise closing it will have to repaint instead.
+        for(int i = 0; i < popupCount; i++) {
+            Popup& popup = popups[i];
+            Rect panel = popupRect(popup);
+            if(!rectsIntersect(touched, panel)) continue;
+            
+            if(rectInside(panel, r) && popup.saveUnder != NULL) {
+                gfx->getImage(panel, popup.saveUnder);
+                popup.saveUnderValid = true;
+            } else if(rectsIntersect(r, panel)) {
+                popup.saveUnderValid = false;
+            }
+            showElementDetails(popup, elements[popup.element]);
+        }
+    }
+    dirtyCount = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Orbit animation
+//
+// While animating, electrons orbit in the focused popup's Bohr diagram. The orbits
+// advance in a fixed-timestep simulation, independent of the frame rate;
+// frames are paced to a target rate on a fixed schedule, and the event wait
+// times out at the next frame deadline, so input is handled between frames
+// rather than after them. Each frame invalidates only the diagram square.
+// Frame times and input latency while animating are kept for p50/p99.
+// ---------------------------------------------------------------------------
+
+const long long ANIMATION_STEP = 1000000000LL / 120;  // simulation timestep
+const int MAX_STEPS_PER_FRAME = 12;
+const int MIN_TARGET_FPS = 10;
+const int MAX_TARGET_FPS = 240;
+const int PERCENTILE_SAMPLES = 1024;
+
+bool animating = false;
+int animatedElement = -1;  // element whose popup is animating
+int targetFps = 60;
+long long lastUpdate = 0;
+long long accumulator = 0;
+long long nextFrameAt = 0;
+double shellTurns[MAX_SHELLS];
+double previousTurns[MAX_SHELLS];
+
+// Ring buffers of the most recent samples
+struct SampleWindow {
+    double ms[PERCENTILE_SAMPLES];
+    int count;
+    int next;
+};
+
+SampleWindow frameTimeSamples = {};
+SampleWindow inputLatencySamples = {};
+
+void addSample(SampleWindow& window, double ms) {
+    window.ms[window.next] = ms;
+    window.next = (window.next + 1) % PERCENTILE_SAMPLES;
+    if(window.count < PERCENTILE_SAMPLES) window.count++;
+}
+
+PercentileStats percentiles(const SampleWindow& window) {
+    PercentileStats stats = { window.count, 0, 0 };
+    if(window.count == 0) return stats;
+    
+    double sorted[PERCENTILE_SAMPLES];
+    copy(window.ms, window.ms + window.count, sorted);
+    int p50 = window.count / 2;
+    int p99 = min(window.count - 1, window.count * 99 / 100);
+    nth_element(sorted, sorted + p50, sorted + window.count);
+    stats.p50Ms = sorted[p50];
+    nth_element(sorted, sorted + p99, sorted + window.count);
+    stats.p99Ms = sorted[p99];
+    return stats;
+}
+
+PercentileStats animationFrameTimes() {
+    return percentiles(frameTimeSamples);
+}
+
+PercentileStats animationInputLatency() {
+    return percentiles(inputLatencySamples);
+}
+
+void printAnimationStats() {
+    PercentileStats frames = animationFrameTimes();
+    PercentileStats input = animationInputLatency();
+    cout << "animation at " << targetFps << " fps: frame p50 " << frames.p50Ms << " ms, p99 "
+         << frames.p99Ms << " ms (" << frames.samples << " frames); input p50 " << input.p50Ms
+         << " ms, p99 " << input.p99Ms << " ms (" << input.samples << " events)" << endl;
+}
+
+void setTargetFps(int fps) {
+    targetFps = max(MIN_TARGET_FPS, min(MAX_TARGET_FPS, fps));
+}
+
+void drawPopupDiagram(const Popup& popup) {
+    const Element& elem = ELEMENTS[popup.element];
+    Rect r = popupDiagramRect(popup);
+    int centerX = (r.left + r.right) / 2;
+    int centerY = (r.top + r.bottom) / 2;
+    if(!animating || popup.element != animatedElement) {
+        drawBohrDiagram(gfx, elem, centerX, centerY);
+        return;
+    }
+    
+    // Draw between the last two simulation states so motion stays smooth
+    // when the frame rate and the timestep don't divide evenly
+    double alpha = (double)accumulator / ANIMATION_STEP;
+    double turns[MAX_SHELLS];
+    for(int s = 0; s < MAX_SHELLS; s++) {
+        turns[s] = previousTurns[s] + (shellTurns[s] - previousTurns[s]) * alpha;
+    }
+    drawBohrDiagramAnimated(gfx, elem, centerX, centerY, turns);
+}
+
+void startAnimation(int element) {
+    animating = true;
+    animatedElement = element;
+    for(int s = 0; s < MAX_SHELLS; s++) shellTurns[s] = previousTurns[s] = 0;
+    lastUpdate = timerNow();
+    accumulator = 0;
+    nextFrameAt = lastUpdate;
+    frameTimeSamples.count = frameTimeSamples.next = 0;
+    inputLatencySamples.count = inputLatencySamples.next = 0;
+}
+
+// Function to stop the animation; its popup is left to the caller, which
+// either closes it or invalidates the diagram to draw it at rest
+void stopAnimation() {
+    if(!animating) return;
+    animating = false;
+    printAnimationStats();
+}
+
+// Function to give the event wait a deadline: the next frame when animating
+int animationTimeoutMs(int timeoutMs) {
+    if(!animating) return timeoutMs;
+    long long wait = nextFrameAt - timerNow();
+    int frameWait = wait <= 0 ? 0 : (int)((wait + 999999) / 1000000);
+    return (timeoutMs == WAIT_FOREVER || frameWait < timeoutMs) ? frameWait : timeoutMs;
+}
+
+// Function to advance the simulation and schedule a frame if one is due;
+// returns true if it invalidated the diagram
+bool updateAnimation() {
+    long long now = timerNow();
+    if(!animating || now < nextFrameAt) return false;
+    
+    accumulator += now - lastUpdate;
+    lastUpdate = now;
+    int steps = 0;
+    while(accumulator >= ANIMATION_STEP && steps < MAX_STEPS_PER_FRAME) {
+        for(int s = 0; s < MAX_SHELLS; s++) {
+            previousTurns[s] = shellTurns[s];
+            shellTurns[s] += bohrShellSpeed(s) * ANIMATION_STEP / 1e9;
+        }
+        accumulator -= ANIMATION_STEP;
+        steps++;
+    }
+    // Far behind (the window was dragged, say): drop the backlog instead of
+    // spending the next frames catching up
+    if(steps == MAX_STEPS_PER_FRAME) accumulator = 0;
+    
+    // Keep frames on a fixed grid; after a miss, restart the grid from now
+    // rather than bunching the missed frames together
+    long long interval = 1000000000LL / targetFps;
+    nextFrameAt += interval;
+    if(nextFrameAt <= now) nextFrameAt = now + interval;
+    
+    int popup = popupFor(animatedElement);
+    if(popup >= 0) invalidateRect(popupDiagramRect(popups[popup]));
+    return true;
+}
+
+// Click-to-paint latency: time from the event being queued to the handler
+// finishing its drawing
+LatencyStats clickLatency = {0, 0, 0, 0};
+bool logClickLatency = true;
+
+const LatencyStats& clickLatencyStats() {
+    return clickLatency;
+}
+
+void recordClickLatency(const InputEvent& ev) {
+    double ms = timerMs(timerNow() - ev.stamp);
+    clickLatency.samples++;
+    clickLatency.lastMs = ms;
+    clickLatency.totalMs += ms;
+    if(ms > clickLatency.worstMs) clickLatency.worstMs = ms;
+    if(!logClickLatency) return;
+    
+    cout << "click-to-paint: " << ms << " ms (avg " << clickLatency.totalMs / clickLatency.samples
+         << " ms, worst " << clickLatency.worstMs << " ms"
+         << (ms > FRAME_BUDGET_MS ? ", OVER FRAME BUDGET)" : ")") << endl;
+}
+
+// ---------------------------------------------------------------------------
+// Back buffer
+//
+// In back-buffer mode every frame is drawn on a hidden page and each dirty
+// region is then copied to the visible page in one getimage/putimage blit,
+// so partially drawn frames are never shown. Both pages therefore always hold
+// the same picture outside the regions being repainted. Press B to switch
+// between this and drawing straight to the visible page; frame times for
+// each mode are printed on every switch.
+// ---------------------------------------------------------------------------
+
+const int FRONT_PAGE = 0;
+const int BACK_PAGE = 1;
+
+enum RenderMode {
+    RENDER_DIRECT,
+    RENDER_BACK_BUFFER
+};
+
+const char* renderModeNames[] = { "direct", "back buffer" };
+
+int renderMode = RENDER_BACK_BUFFER;
+FrameStats frameStats[2] = { {0, 0, 0}, {0, 0, 0} };
+void* presentBuffer = NULL;
+
+// Function to allocate the blit buffer
+void initBackBuffer() {
+    presentBuffer = malloc(gfx->imageSize(screenRect()));
+    if(presentBuffer == NULL) renderMode = RENDER_DIRECT;
+    gfx->setVisualPage(FRONT_PAGE);
+}
+
+void printFrameStats() {
+    for(int mode = RENDER_DIRECT; mode <= RENDER_BACK_BUFFER; mode++) {
+        const FrameStats& stats = frameStats[mode];
+        if(stats.frames == 0) continue;
+        cout << renderModeNames[mode] << ": " << stats.frames << " frames, avg "
+             << stats.totalMs / stats.frames << " ms, worst " << stats.worstMs << " ms" << endl;
+    }
+}
+
+const FrameStats& currentFrameStats() {
+    return frameStats[renderMode];
+}
+
+void toggleRenderMode() {
+    printFrameStats();
+    renderMode = (renderMode == RENDER_DIRECT && presentBuffer != NULL) ? RENDER_BACK_BUFFER : RENDER_DIRECT;
+    cout << "rendering mode: " << renderModeNames[renderMode] << endl;
+    
+    // The back page missed everything drawn in direct mode
+    invalidateRect(screenRect());
+}
+
+void renderFrame(const Element elements[], int count) {
+    long long start = timerNow();
+    
+    // Closed popups: put the saved screen back on both pages, one blit each.
+    // Anything dirty underneath is repainted over it next.
+    for(int i = 0; i < restoreCount; i++) {
+        const Rect& r = restores[i].rect;
+        if(renderMode == RENDER_BACK_BUFFER) {
+            gfx->setActivePage(BACK_PAGE);
+            gfx->putImage(r.left, r.top, restores[i].image, IMAGE_COPY);
+        }
+        gfx->setActivePage(FRONT_PAGE);
+        gfx->putImage(r.left, r.top, restores[i].image, IMAGE_COPY);
+        free(restores[i].image);
+    }
+    restoreCount = 0;
+    
+    if(renderMode == RENDER_DIRECT) {
+        gfx->setActivePage(FRONT_PAGE);
+        repaintDirty(elements, count);
+    } else {
+        Rect regions[MAX_DIRTY_RECTS];
+        int regionCount = dirtyCount;
+        for(int i = 0; i < regionCount; i++) regions[i] = dirtyRects[i];
+        
+        gfx->setActivePage(BACK_PAGE);
+        repaintDirty(elements, count);
+        
+        for(int i = 0; i < regionCount; i++) {
+            const Rect& r = regions[i];
+            gfx->setActivePage(BACK_PAGE);
+            gfx->getImage(r, presentBuffer);
+            gfx->setActivePage(FRONT_PAGE);
+            gfx->putImage(r.left, r.top, presentBuffer, IMAGE_COPY);
+        }
+    }
+    
+    double ms = timerMs(timerNow() - start);
+    FrameStats& stats = frameStats[renderMode];
+    stats.frames++;
+    stats.totalMs += ms;
+    if(ms > stats.worstMs) stats.worstMs = ms;
+}
+
+// ---------------------------------------------------------------------------
+// Nuclide chart
+//
+// N switches the window to the chart of the nuclides (nuclide_chart.h),
+// centred on the focused popup's element if there is one, and N or Escape
+// switches back. W/A/S/D or the arrows pan by a quarter of the view, +/-
+// zoom about its centre and the wheel about the pointer. Hovering a cell
+// shows the nuclide in the status line and a click selects it. A pan or
+// zoom invalidates the whole chart area, which the cull in
+// drawNuclideChart keeps down to the cells in view; hovering repaints two
+// cells.
+// ---------------------------------------------------------------------------
+
+ChartView chartView = { {0, 0, 0, 0}, 2, 0, 0, -1, -1 };
+bool chartPlaced = false;
+int chartMouseX = -1;
+int chartMouseY = -1;
+
+Rect chartAreaRect() {
+    return makeRect(baseX, baseY + 10, legendX - 30, statusRect().top - 8);
+}
+
+// A cell with the outline drawn around it when hovered or selected
+Rect chartOutlineRect(int index) {
+    const Nuclide& nuclide = nuclideTable().nuclide[index];
+    Rect r = chartCellRect(chartView, nuclide.n, nuclide.z);
+    return makeRect(r.left - 1, r.top - 1, r.right + 1, r.bottom + 1);
+}
+
+// Function to centre the chart on an element's most abundant nuclide, or
+// the middle of its run if none occur naturally
+void centerChartOnElement(int z) {
+    const NuclideTable& table = nuclideTable();
+    int begin = table.first[z], end = table.first[z + 1];
+    int best = begin < end ? (begin + end) / 2 : -1;
+    for(int i = begin; i < end; i++) {
+        if(table.nuclide[i].abundance > 0 && table.nuclide[i].abundance > table.nuclide[best].abundance) best = i;
+    }
+    centerChart(chartView, table, best >= 0 ? table.nuclide[best].n : z, z);
+}
+
+void drawChartTitle() {
+    gfx->setTextStyle(FONT_GOTHIC, 3);
+    gfx->setColor(COLOR_WHITE);
+    gfx->text(baseX, 5, "Chart of the Nuclides");
+}
+
+void drawChartStatus() {
+    const NuclideTable& table = nuclideTable();
+    int shown = chartView.hovered >= 0 ? chartView.hovered : chartView.selected;
+    char line[200];
+    if(shown >= 0) {
+        const Nuclide& nuclide = table.nuclide[shown];
+        char halfLife[24], abundance[32] = "";
+        formatHalfLife(halfLife, sizeof(halfLife), nuclide.halfLife);
+        if(nuclide.abundance > 0) snprintf(abundance, sizeof(abundance), "    abundance %.4g%%", nuclide.abundance);
+        snprintf(line, sizeof(line), "%s-%d (Z %d, N %d)    half-life %s    %s%s", ELEMENTS[nuclide.z - 1].symbol,
+                 nuclide.z + nuclide.n, nuclide.z, nuclide.n, halfLife, decayModeName(nuclide.decay), abundance);
+    } else {
+        snprintf(line, sizeof(line), "%d nuclides    W/A/S/D, arrows: pan    +/-, wheel: zoom (%d px)    N or Esc: back to the table",
+                 table.count, chartCellSize(chartView));
+    }
+    Rect r = statusRect();
+    gfx->setTextStyle(FONT_SMALL, 5);
+    gfx->setColor(COLOR_LIGHTGRAY);
+    gfx->text(baseX, r.top + 4, line);
+}
+
+// Function to repaint one dirty region while the chart is showing
+void repaintChart(const Rect& r) {
+    gfx->setFillColor(COLOR_BLACK);
+    gfx->bar(r.left, r.top, r.right, r.bottom);
+    if(rectsIntersect(r, titleRect())) drawChartTitle();
+    if(rectsIntersect(r, legendRect())) drawDecayLegend(gfx, legendX, legendY);
+    if(rectsIntersect(r, statusRect())) drawChartStatus();
+    drawNuclideChart(gfx, chartView, nuclideTable(), r);
+}
+
+void openChart() {
+    if(animating) stopAnimation();  // its popup is about to be covered
+    chartOpen = true;
+    hoveredIndex = -1;
+    chartView.area = chartAreaRect();
+    chartView.hovered = -1;
+    if(popupCount > 0) centerChartOnElement(popups[popupCount - 1].element + 1);
+    else if(!chartPlaced) centerChartOnElement(26);
+    chartPlaced = true;
+    invalidateRect(screenRect());
+}
+
+void closeChart() {
+    chartOpen = false;
+    invalidateRect(screenRect());  // popups refresh their save-unders in this repaint
+}
+
+// Function to move the hover to whatever is under the mouse now
+void updateChartHover() {
+    int index = chartNuclideAt(chartView, nuclideTable(), chartMouseX, chartMouseY);
+    if(index == chartView.hovered) return;
+    if(chartView.hovered >= 0) invalidateRect(chartOutlineRect(chartView.hovered));
+    if(index >= 0) invalidateRect(chartOutlineRect(index));
+    chartView.hovered = index;
+    invalidateRect(statusRect());
+}
+
+// Function to repaint after a pan or zoom of the chart
+void chartMoved(const ChartView& before) {
+    if(chartView.zoom == before.zoom && chartView.scrollX == before.scrollX && chartView.scrollY == before.scrollY) return;
+    invalidateRect(chartView.area);
+    invalidateRect(statusRect());
+    chartView.hovered = -1;
+    updateChartHover();
+}
+
+// Function to handle an input event while the chart is showing
+void handleChartEvent(const InputEvent& ev) {
+    const NuclideTable& table = nuclideTable();
+    if(ev.type == EVENT_WHEEL) {
+        ChartView before = chartView;
+        chartMouseX = ev.x;
+        chartMouseY = ev.y;
+        zoomChart(chartView, table, ev.key, ev.x, ev.y);
+        chartMoved(before);
+        return;
+    }
+    if(ev.type == EVENT_KEY) {
+        int key = ev.key;
+        if(key == 'n' || key == 'N' || key == KEY_ESCAPE) {
+            closeChart();
+            return;
+        }
+        if(key == 'b' || key == 'B') {
+            toggleRenderMode();
+            return;
+        }
+        
+        ChartView before = chartView;
+        int width = chartView.area.right - chartView.area.left + 1;
+        int height = chartView.area.bottom - chartView.area.top + 1;
+        int centerX = (chartView.area.left + chartView.area.right) / 2;
+        int centerY = (chartView.area.top + chartView.area.bottom) / 2;
+        if(key == 'w' || key == 'W' || key == KEY_UP) panChart(chartView, table, 0, height / 4);
+        else if(key == 's' || key == 'S' || key == KEY_DOWN) panChart(chartView, table, 0, -height / 4);
+        else if(key == 'a' || key == 'A' || key == KEY_LEFT) panChart(chartView, table, -width / 4, 0);
+        else if(key == 'd' || key == 'D' || key == KEY_RIGHT) panChart(chartView, table, width / 4, 0);
+        else if(key == '+' || key == '=') zoomChart(chartView, table, 1, centerX, centerY);
+        else if(key == '-') zoomChart(chartView, table, -1, centerX, centerY);
+        chartMoved(before);
+        return;
+    }
+    
+    if(ev.type == EVENT_MOUSEMOVE) {
+        chartMouseX = ev.x;
+        chartMouseY = ev.y;
+        updateChartHover();
+        return;
+    }
+    
+    if(ev.type == EVENT_CLICK) {
+        int index = chartNuclideAt(chartView, table, ev.x, ev.y);
+        if(index == chartView.selected) return;
+        if(chartView.selected >= 0) invalidateRect(chartOutlineRect(chartView.selected));
+        if(index >= 0) invalidateRect(chartOutlineRect(index));
+        chartView.selected = index;
+        invalidateRect(statusRect());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// View handlers
+// ---------------------------------------------------------------------------
+
+void closePopup(const Element elements[], int which);
+
+bool slotTaken(int slot) {
+    for(int i = 0; i < popupCount; i++) {
+        if(popups[i].slot == slot) return true;
+    }
+    return false;
+}
+
+// Function to find the first slot that is free and on screen, or -1
+int freePopupSlot() {
+    for(int slot = 0; slot < MAX_POPUPS; slot++) {
+        if(popupSlotFits(slot) && !slotTaken(slot)) return slot;
+    }
+    return -1;
+}
+
+// Function to open a detail popup in a free slot, closing the oldest one if
+// all the slots that fit the window are taken. The repaint that draws it
+// also fills its save-under.
+void openPopup(const Element elements[], int index) {
+    if(popupFor(index) >= 0) return;
+    int slot = freePopupSlot();
+    if(slot < 0) {
+        closePopup(elements, 0);
+        slot = freePopupSlot();
+    }
+    
+    Popup& popup = popups[popupCount++];
+    popup.element = index;
+    popup.slot = slot;
+    popup.saveUnder = malloc(gfx->imageSize(popupSlotRect(slot)));
+    popup.saveUnderValid = false;
+    
+    invalidateRect(elementRect(elements[index]));
+    invalidateRect(popupSlotRect(slot));
+}
+
+// Function to close a popup: one blit from its save-under if that is still
+// current, otherwise a repaint of the area it covered
+void closePopup(const Element elements[], int which) {
+    Popup popup = popups[which];
+    for(int i = which; i + 1 < popupCount; i++) popups[i] = popups[i + 1];
+    popupCount--;
+    
+    if(animating && animatedElement == popup.element) stopAnimation();
+    
+    Rect r = popupRect(popup);
+    if(popup.saveUnderValid) {
+        restores[restoreCount].rect = r;
+        restores[restoreCount].image = popup.saveUnder;
+        restoreCount++;
+    } else {
+        free(popup.saveUnder);
+        invalidateRect(r);
+    }
+    invalidateRect(elementRect(elements[popup.element]));
+}
+
+int popupAt(int x, int y) {
+    for(int i = popupCount - 1; i >= 0; i--) {
+        Rect r = popupRect(popups[i]);
+        if(x >= r.left && x <= r.right && y >= r.top && y <= r.bottom) return i;
+    }
+    return -1;
+}
+
+bool rectContains(const Rect& r, int x, int y) {
+    return x >= r.left && x <= r.right && y >= r.top && y <= r.bottom;
+}
+
+// Cells under a popup, the title, the legend or the status line can't be
+// hovered or clicked through it
+bool tableCoveredAt(int x, int y) {
+    return popupAt(x, y) >= 0 || rectContains(titleRect(), x, y) ||
+           rectContains(legendRect(), x, y) || rectContains(statusRect(), x, y);
+}
+
+int tableMouseX = -1;
+int tableMouseY = -1;
+
+// Function to move the hover to the cell at (x, y), if any
+void hoverAt(const Element elements[], int x, int y) {
+    tableMouseX = x;
+    tableMouseY = y;
+    int index = tableCoveredAt(x, y) ? -1 : elementAt(elements, tableView, x, y);
+    if(index == hoveredIndex) return;
+    
+    if(hoveredIndex >= 0) invalidateRect(elementRect(elements[hoveredIndex]));
+    if(index >= 0) invalidateRect(elementRect(elements[index]));
+    hoveredIndex = index;
+}
+
+// Function to give the screen area the whole table covers, outlines included
+Rect tableBounds() {
+    int cell = tableView.cellSize;
+    return makeRect(tableView.originX - 1, tableView.originY - 1,
+                    tableView.originX + GRID_COLS * cell + 1, tableView.originY + GRID_ROWS * cell + 1);
+}
+
+int tableCellSize() {
+    return tableView.cellSize;
+}
+
+int zoomedCellSize(int steps) {
+    return ZOOM_CELL_SIZES[max(0, min(ZOOM_LEVELS - 1, zoomLevel + steps))];
+}
+
+// Function to pick the largest cell size at which the table, at its layout
+// position, fits between the title, the legend and the popup strip (the
+// first slot's row, which every window size has)
+int fittedZoomLevel() {
+    int width = legendX - 30 - baseX;
+    int height = popupSlotRect(0).top - 2 - baseY;
+    int level = 0;
+    while(level + 1 < ZOOM_LEVELS && ZOOM_CELL_SIZES[level + 1] * GRID_COLS <= width &&
+          ZOOM_CELL_SIZES[level + 1] * GRID_ROWS <= height) {
+        level++;
+    }
+    return level;
+}
+
+// Function to change the view and repaint where the table was and now is.
+// At least a cell's worth of the table is kept on screen.
+void moveTableView(const Element elements[], int level, int originX, int originY) {
+    int cell = ZOOM_CELL_SIZES[level];
+    originX = max(cell - GRID_COLS * cell, min(gfx->maxX() - cell, originX));
+    originY = max(cell - GRID_ROWS * cell, min(gfx->maxY() - cell, originY));
+    if(level == zoomLevel && originX == tableView.originX && originY == tableView.originY) return;
+    
+    Rect before = tableBounds();
+    zoomLevel = level;
+    tableView.cellSize = cell;
+    tableView.originX = originX;
+    tableView.originY = originY;
+    touchTileLevel();
+    invalidateRect(rectUnion(before, tableBounds()));
+    hoverAt(elements, tableMouseX, tableMouseY);
+}
+
+// Function to zoom by a number of ladder steps, keeping the table point
+// under (x, y) where it is
+void zoomTable(const Element elements[], int steps, int x, int y) {
+    int level = max(0, min(ZOOM_LEVELS - 1, zoomLevel + steps));
+    double scale = (double)zoomedCellSize(steps) / tableView.cellSize;
+    int originX = x - (int)lround((x - tableView.originX) * scale);
+    int originY = y - (int)lround((y - tableView.originY) * scale);
+    moveTableView(elements, level, originX, originY);
+}
+
+// Function to handle the zoom and pan keys; returns false for other keys
+bool handleViewKey(const Element elements[], int key) {
+    Rect screen = screenRect();
+    Rect visible = tableBounds();
+    visible.left = max(visible.left, screen.left);
+    visible.top = max(visible.top, screen.top);
+    visible.right = min(visible.right, screen.right);
+    visible.bottom = min(visible.bottom, screen.bottom);
+    int centerX = (visible.left + visible.right) / 2;
+    int centerY = (visible.top + visible.bottom) / 2;
+    int stepX = (screen.right + 1) / 4;
+    int stepY = (screen.bottom + 1) / 4;
+    
+    if(key == ']') zoomTable(elements, 1, centerX, centerY);
+    else if(key == '[') zoomTable(elements, -1, centerX, centerY);
+    else if(key == KEY_LEFT) moveTableView(elements, zoomLevel, tableView.originX + stepX, tableView.originY);
+    else if(key == KEY_RIGHT) moveTableView(elements, zoomLevel, tableView.originX - stepX, tableView.originY);
+    else if(key == KEY_UP) moveTableView(elements, zoomLevel, tableView.originX, tableView.originY + stepY);
+    else if(key == KEY_DOWN) moveTableView(elements, zoomLevel, tableView.originX, tableView.originY - stepY);
+    else if(key == '0') moveTableView(elements, fittedZoomLevel(), baseX, baseY);
+    else return false;
+    return true;
+}
+
+// Function to handle a key aimed at the focused popup; returns false if it
+// is not a popup key
+bool handlePopupKey(const Element elements[], int key) {
+    if(popupCount == 0) return false;
+    const Popup& top = popups[popupCount - 1];
+    
+    if(key == KEY_ESCAPE) {
+        closePopup(elements, popupCount - 1);
+        return true;
+    }
+    if(key == 'a' || key == 'A') {
+        bool restart = !animating || animatedElement != top.element;
+        if(animating) {
+            stopAnimation();
+            int previous = popupFor(animatedElement);
+            if(previous >= 0) invalidateRect(popupDiagramRect(popups[previous]));
+        }
+        if(restart) startAnimation(top.element);
+        return true;
+    }
+    if(key == '+' || key == '-') {
+        setTargetFps(targetFps + (key == '+' ? 10 : -10));
+        cout << "target frame rate: " << targetFps << " fps" << endl;
+        return true;
+    }
+    return false;
+}
+
+// Function to handle an input event; popups are non-modal, so the table
+// keeps working around them
+void handleTableEvent(const Element elements[], const InputEvent& ev) {
+    if(ev.type == EVENT_WAKE) return;  // the reload was picked up already
+    if(chartOpen) {
+        handleChartEvent(ev);
+        return;
+    }
+    if(ev.type == EVENT_KEY && inputMode != INPUT_NONE) {
+        handleInputKey(elements, ev.key);
+        return;
+    }
+    if(ev.type == EVENT_KEY && handlePopupKey(elements, ev.key)) return;
+    if(ev.type == EVENT_KEY && handleViewKey(elements, ev.key)) return;
+    if(ev.type == EVENT_WHEEL) {
+        tableMouseX = ev.x;
+        tableMouseY = ev.y;
+        zoomTable(elements, ev.key, ev.x, ev.y);
+        return;
+    }
+    if(ev.type == EVENT_KEY && (ev.key == 'b' || ev.key == 'B')) {
+        toggleRenderMode();
+        return;
+    }
+    if(ev.type == EVENT_KEY && (ev.key == 'h' || ev.key == 'H')) {
+        cycleHeatmap(elements);
+        return;
+    }
+    if(ev.type == EVENT_KEY && (ev.key == 'n' || ev.key == 'N')) {
+        openChart();
+        return;
+    }
+    if(ev.type == EVENT_KEY && (ev.key == 'x' || ev.key == 'X')) {
+        clearComparison(elements);
+        return;
+    }
+    if(ev.type == EVENT_KEY && (ev.key == 'f' || ev.key == 'F' || ev.key == '/')) {
+        inputMode = ev.key == '/' ? INPUT_SEARCH : INPUT_FILTER;
+        applyInputText(elements);
+        return;
+    }
+    if(ev.type == EVENT_KEY && ev.key == KEY_ESCAPE) {
+        filterText[0] = '\0';
+        searchText[0] = '\0';
+        applyFilterText(elements);
+        applySearchText(elements);
+        return;
+    }
+    
+    if(ev.type == EVENT_MOUSEMOVE) {
+        hoverAt(elements, ev.x, ev.y);
+        return;
+    }
+    
+    if(ev.type == EVENT_CLICK) {
+        if(popupAt(ev.x, ev.y) >= 0) {
+            closePopup(elements, popupAt(ev.x, ev.y));
+            return;
+        }
+        if(tableCoveredAt(ev.x, ev.y)) return;
+        
+        int index = elementAt(elements, tableView, ev.x, ev.y);
+        if(index < 0) return;
+        if(ev.modifiers & MOD_SHIFT) toggleComparison(elements, index);
+        else if(popupFor(index) >= 0) closePopup(elements, popupFor(index));
+        else openPopup(elements, index);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Data reload
+//
+// The watcher thread (element_reload.h) publishes a new table and wakes the
+// view. The view keeps a copy of the columns it last drew from; comparing
+// against it finds the elements that changed, and only what they show is
+// repainted: heat cells whose level moved, the filter result, comparison
+// rows, any open popups, and cells large enough to show the atomic weight.
+// ---------------------------------------------------------------------------
+
+ElementColumns shownColumns;
+unsigned shownGeneration = 0;
+
+// Function to pick up a newly published table, if there is one
+void refreshElementData(const Element elements[]) {
+    unsigned generation = elementColumnsGeneration();
+    if(generation == shownGeneration) return;
+    const ElementColumns& columns = elementColumns();
+    
+    bool changed[COLUMN_CAPACITY] = {};
+    int changedCount = 0;
+    for(int i = 0; i < columns.count; i++) {
+        for(int p = 0; p < PROP_COUNT && !changed[i]; p++) {
+            // memcmp, so NaN to NaN is no change
+            if(memcmp(&propertyColumn(columns, p)[i], &propertyColumn(shownColumns, p)[i], sizeof(double)) != 0) {
+                changed[i] = true;
+                changedCount++;
+            }
+        }
+    }
+    
+    if(heatmapProperty >= 0) {
+        // A change to one value can shift the quantiles and so other cells
+        static HeatmapTable shownHeat;
+        buildHeatmapTable(shownColumns, shownHeat);
+        const HeatmapTable& heat = heatmapTable();
+        for(int i = 0; i < columns.count; i++) {
+            if(heat.level[heatmapProperty][i] != shownHeat.level[heatmapProperty][i]) {
+                invalidateRect(elementRect(elements[i]));
+            }
+        }
+        if(memcmp(&heat.scale[heatmapProperty], &shownHeat.scale[heatmapProperty], sizeof(PropertyScale)) != 0) {
+            invalidateRect(legendRect());
+        }
+    }
+    for(int i = 0; i < columns.count && i < ELEMENT_COUNT; i++) {
+        if(!changed[i]) continue;
+        discardDetailTiles(i);
+        if(tableView.cellSize >= LOD_DETAIL_CELL) invalidateRect(elementRect(elements[i]));
+    }
+    if(filterText[0] != '\0' && filterValid) applyFilterText(elements);
+    updateComparison();
+    for(int i = 0; i < popupCount; i++) {
+        if(changed[popups[i].element]) invalidateRect(popupRect(popups[i]));
+    }
+    
+    memcpy(&shownColumns, &columns, sizeof(ElementColumns));
+    shownGeneration = generation;
+    cout << "element data: " << changedCount << " element(s) changed" << endl;
+}
+
+void wakeTableView() {
+    gfx->wake();
+}
+
+void initTableView(RenderBackend* backend) {
+    gfx = backend;
+    legendX = gfx->maxX() + 1 - 200;
+    zoomLevel = fittedZoomLevel();
+    tableView.cellSize = ZOOM_CELL_SIZES[zoomLevel];
+    buildHitGrid(ELEMENTS, ELEMENT_COUNT);
+    initBackBuffer();
+    gfx->setActivePage(BACK_PAGE);
+    initTileCache(ELEMENTS, ELEMENT_COUNT);
+    initHeatmap(ELEMENTS, ELEMENT_COUNT);
+    shownGeneration = elementColumnsGeneration();
+    memcpy(&shownColumns, &elementColumns(), sizeof(ElementColumns));
+    invalidateRect(screenRect());
+    renderFrame(ELEMENTS, ELEMENT_COUNT);
+}
+
+bool processNextEvent(int timeoutMs) {
+    InputEvent ev;
+    bool received = gfx->waitForEvent(ev, animationTimeoutMs(timeoutMs));
+    refreshElementData(ELEMENTS);
+    
+    if(received) {
+        bool wasAnimating = animating;
+        handleTableEvent(ELEMENTS, ev);
+        if(wasAnimating) addSample(inputLatencySamples, timerMs(timerNow() - ev.stamp));
+    }
+    bool animationFrame = updateAnimation();
+    
+    if(dirtyCount > 0 || restoreCount > 0) {
+        long long start = timerNow();
+        renderFrame(ELEMENTS, ELEMENT_COUNT);
+        if(animationFrame) addSample(frameTimeSamples, timerMs(timerNow() - start));
+        if(received && ev.type == EVENT_CLICK) recordClickLatency(ev);
+    }
+    return received;
+}
@@ -0,0 +1,72 @@
+#ifndef TABLE_VIEW_H
+#define TABLE_VIEW_H
+
+#include "elements.h"
+#include "render_backend.h"
+
+// The interactive periodic table: drawing, retained-mode repaint and the
+// handlers for the table and the detail popup. Renders through whichever
+// RenderBackend is passed to initTableView.
+
+struct LatencyStats {
+    int samples;
+    double lastMs;
+    double worstMs;
+    double totalMs;
+};
+
+struct FrameStats {
+    int frames;
+    double totalMs;
+    double worstMs;
+};
+
+struct PercentileStats {
+    int samples;
+    double p50Ms;
+    double p99Ms;
+};
+
+// Function to fit the table to the backend's screen, build the hit grid and
+// tile cache and draw the first frame
+void initTableView(RenderBackend* backend);
+
+// Function to wait for one input event, dispatch it to the table or popup
+// handler and repaint whatever it changed. While the orbit animation runs
+// the wait also ends at the next frame deadline and the frame is drawn.
+// Returns false if no event arrived.
+bool processNextEvent(int timeoutMs);
+
+// Function to wake the view from another thread after the element data was
+// reloaded; the next processNextEvent repaints what changed. Pass it to
+// startDataWatcher.
+void wakeTableView();
+
+// Function to mark a screen region for repainting on the next frame
+void invalidateRect(Rect r);
+Rect screenRect();
+
+// Function to draw all dirty regions and put the finished frame on screen
+void renderFrame(const Element elements[], int count);
+
+// Pixels per table cell at the current zoom (the wheel, [ and ] change it)
+int tableCellSize();
+
+// Function to give the cell size a number of zoom steps from the current
+// one, held at the ends of the ladder
+int zoomedCellSize(int steps);
+
+void printFrameStats();
+const FrameStats& currentFrameStats();
+const LatencyStats& clickLatencyStats();
+
+// Orbit animation in the detail popup (A toggles it while a popup is open)
+void setTargetFps(int fps);
+PercentileStats animationFrameTimes();
+PercentileStats animationInputLatency();
+void printAnimationStats();
+
+// Click-to-paint latency is printed per click unless this is false
+extern bool logClickLatency;
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <chrono>
+
+// Monotonic clock helpers used for the latency and frame-time figures.
+// Ticks are nanoseconds.
+
+inline long long timerNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline double timerMs(long long ticks) {
+    return ticks / 1000000.0;
+}
+
+#endif